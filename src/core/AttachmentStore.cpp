@@ -0,0 +1,63 @@
+#include "AttachmentStore.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace {
+QString store(const QString& root, const QByteArray& data, const QString& extension)
+{
+    if (data.isEmpty()) {
+        return {};
+    }
+
+    const QString hash     = QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex());
+    const QString relative = hash.left(2) + "/" + hash + "." + extension;
+    const QString absolute = root + "/" + relative;
+
+    // Identical content is already stored under the same name
+    if (QFileInfo::exists(absolute)) {
+        return relative;
+    }
+
+    if (!QDir().mkpath(QFileInfo(absolute).absolutePath())) {
+        return {};
+    }
+    QSaveFile file(absolute);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        return {};
+    }
+    return relative;
+}
+}
+
+QString AttachmentStore::rootForProfile(const QString& profilePath)
+{
+    QDir instance(profilePath);
+    instance.cdUp(); // profiles
+    instance.cdUp(); // instance
+    return instance.absoluteFilePath("notes_attachments");
+}
+
+QString AttachmentStore::storeImage(const QString& root, const QImage& image)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, "PNG")) {
+        return {};
+    }
+    return store(root, data, "png");
+}
+
+QString AttachmentStore::storeFile(const QString& root, const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    return store(root, file.readAll(), QFileInfo(filePath).suffix().toLower());
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QImage>
+#include <QString>
+
+// Content-addressed store for pasted and dropped images, shared by all profiles; safe to call from workers
+namespace AttachmentStore {
+
+// <instance>/notes_attachments for a profile at <instance>/profiles/<name>
+QString rootForProfile(const QString& profilePath);
+
+// Stores the image as PNG; returns the path relative to the store root, or an empty string on failure
+QString storeImage(const QString& root, const QImage& image);
+
+// Stores a copy of the file, keeping its extension; returns the relative path, or an empty string on failure
+QString storeFile(const QString& root, const QString& filePath);
+
+}
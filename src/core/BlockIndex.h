@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QTextBlock>
+#include <QTextDocument>
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+// Blocks of a QTextDocument that match some criterion by block number; update() only re-scans the changed blocks
+template <typename T>
+class BlockIndex {
+public:
+    struct Entry {
+        int block;
+        T value;
+    };
+
+    // Entries the last update() took out and put in, for callers keeping aggregates
+    struct Change {
+        std::vector<Entry> removed;
+        std::vector<Entry> added;
+    };
+
+    template <typename Scan>
+    void reset(const QTextDocument* document, Scan scan)
+    {
+        m_entries.clear();
+        int number = 0;
+        for (QTextBlock block = document->begin(); block.isValid(); block = block.next(), ++number) {
+            if (std::optional<T> value = scan(block)) {
+                m_entries.push_back({ number, std::move(*value) });
+            }
+        }
+        m_blockCount = document->blockCount();
+    }
+
+    template <typename Scan>
+    Change update(const QTextDocument* document, const int position, const int charsAdded, Scan scan)
+    {
+        const int blockCount = document->blockCount();
+        const int delta      = blockCount - m_blockCount;
+
+        QTextBlock block = document->findBlock(position);
+        QTextBlock last  = document->findBlock(position + charsAdded);
+        if (!block.isValid()) {
+            block = document->lastBlock();
+        }
+        if (!last.isValid()) {
+            last = document->lastBlock();
+        }
+        const int first   = block.blockNumber();
+        const int newLast = last.blockNumber();
+        const int oldLast = newLast - delta; // last touched block before the change
+        if (oldLast < first) {
+            // The change does not fit the blocks we know about; start over
+            Change change;
+            change.removed = std::move(m_entries);
+            reset(document, scan);
+            change.added = m_entries;
+            return change;
+        }
+        m_blockCount = blockCount;
+
+        Change change;
+        for (int number = first; block.isValid() && number <= newLast; block = block.next(), ++number) {
+            if (std::optional<T> value = scan(block)) {
+                change.added.push_back({ number, std::move(*value) });
+            }
+        }
+
+        const auto begin = std::lower_bound(m_entries.begin(), m_entries.end(), first,
+            [](const Entry& entry, const int number) { return entry.block < number; });
+        const auto end = std::upper_bound(begin, m_entries.end(), oldLast,
+            [](const int number, const Entry& entry) { return number < entry.block; });
+        for (auto it = end; it != m_entries.end(); ++it) {
+            it->block += delta;
+        }
+        change.removed.assign(std::make_move_iterator(begin), std::make_move_iterator(end));
+        m_entries.insert(m_entries.erase(begin, end), change.added.begin(), change.added.end());
+        return change;
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+        m_blockCount = 1;
+    }
+
+    [[nodiscard]] const std::vector<Entry>& entries() const { return m_entries; }
+
+private:
+    std::vector<Entry> m_entries;
+    int m_blockCount = 1; // an empty document still has one block
+};
@@ -0,0 +1,133 @@
+#include "ChangelogBatch.h"
+
+#include <QStringList>
+
+#include <algorithm>
+
+namespace {
+constexpr qsizetype MAX_NAMED = 8; // beyond this many, a group is summarized by its count
+
+// "enabled `A`, `B`", or "enabled 500 mods: `A`, ... and 492 more"
+QString describe(const QString& verb, const QString& noun, const QStringList& items)
+{
+    const QStringList named = items.first(std::min(items.size(), MAX_NAMED));
+    if (items.size() <= MAX_NAMED) {
+        return QString("%1 %2").arg(verb, named.join(", "));
+    }
+    return QString("%1 %2 %3: %4 and %5 more")
+        .arg(verb, QString::number(items.size()), noun, named.join(", "), QString::number(items.size() - MAX_NAMED));
+}
+
+QString quoted(const QString& name) { return "`" + name + "`"; }
+
+QStringList sortedQuoted(const QSet<QString>& names)
+{
+    QStringList list(names.cbegin(), names.cend());
+    list.sort(Qt::CaseInsensitive);
+    for (QString& name : list) {
+        name = quoted(name);
+    }
+    return list;
+}
+}
+
+void ChangelogBatch::setEnabled(const Kind kind, const QString& name, const bool enabled)
+{
+    Change& change = m_changes[static_cast<int>(kind)][name];
+    if (!change.stateKnown) {
+        // Only the new state is reported, so a change means it used to be the opposite
+        change.wasEnabled = !enabled;
+        change.stateKnown = true;
+    }
+    change.isEnabled = enabled;
+}
+
+void ChangelogBatch::setPriority(const Kind kind, const QString& name, const int from, const int to)
+{
+    Change& change = m_changes[static_cast<int>(kind)][name];
+    if (change.fromPriority < 0) {
+        change.fromPriority = from;
+    }
+    change.toPriority = to;
+}
+
+void ChangelogBatch::addInstalled(const QString& mod)
+{
+    if (!m_removed.remove(mod)) {
+        m_installed.insert(mod);
+    }
+}
+
+void ChangelogBatch::addRemoved(const QString& mod)
+{
+    // A mod installed and removed again within the batch was never there
+    if (!m_installed.remove(mod)) {
+        m_removed.insert(mod);
+    }
+    m_changes[static_cast<int>(Kind::Mod)].remove(mod);
+}
+
+bool ChangelogBatch::isEmpty() const
+{
+    if (!m_installed.isEmpty() || !m_removed.isEmpty()) {
+        return false;
+    }
+    return std::ranges::all_of(m_changes, [](const QMap<QString, Change>& changes) {
+        return std::none_of(changes.cbegin(), changes.cend(), [](const Change& change) {
+            return (change.stateKnown && change.wasEnabled != change.isEnabled)
+                || change.fromPriority != change.toPriority;
+        });
+    });
+}
+
+void ChangelogBatch::clear()
+{
+    for (QMap<QString, Change>& changes : m_changes) {
+        changes.clear();
+    }
+    m_installed.clear();
+    m_removed.clear();
+}
+
+QString ChangelogBatch::entry(const QDateTime& time) const
+{
+    QStringList parts;
+    if (!m_installed.isEmpty()) {
+        parts.append(describe("installed", "mods", sortedQuoted(m_installed)));
+    }
+    if (!m_removed.isEmpty()) {
+        parts.append(describe("removed", "mods", sortedQuoted(m_removed)));
+    }
+
+    for (const Kind kind : { Kind::Mod, Kind::Plugin }) {
+        QStringList enabled;
+        QStringList disabled;
+        QStringList moved;
+        const QMap<QString, Change>& changes = m_changes[static_cast<int>(kind)];
+        for (auto it = changes.cbegin(); it != changes.cend(); ++it) {
+            if (it->stateKnown && it->wasEnabled != it->isEnabled) {
+                (it->isEnabled ? enabled : disabled).append(quoted(it.key()));
+            }
+            if (it->fromPriority != it->toPriority) {
+                const QString from = QString::number(it->fromPriority);
+                const QString to   = QString::number(it->toPriority);
+                moved.append(QString("%1 (%2 → %3)").arg(quoted(it.key()), from, to));
+            }
+        }
+        const QString noun = kind == Kind::Mod ? "mods" : "plugins";
+        if (!enabled.isEmpty()) {
+            parts.append(describe("enabled", noun, enabled));
+        }
+        if (!disabled.isEmpty()) {
+            parts.append(describe("disabled", noun, disabled));
+        }
+        if (!moved.isEmpty()) {
+            parts.append(describe("moved", noun, moved));
+        }
+    }
+
+    if (parts.isEmpty()) {
+        return {};
+    }
+    return QString("- **%1** %2").arg(time.toString("yyyy-MM-dd HH:mm"), parts.join("; "));
+}
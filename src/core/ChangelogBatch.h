@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QDateTime>
+#include <QMap>
+#include <QSet>
+#include <QString>
+
+// Mod and plugin list changes merged per name into one changelog line; a change undone within the batch logs nothing
+class ChangelogBatch {
+public:
+    enum class Kind {
+        Mod,
+        Plugin,
+    };
+
+    void setEnabled(Kind kind, const QString& name, bool enabled);
+    void setPriority(Kind kind, const QString& name, int from, int to);
+    void addInstalled(const QString& mod);
+    void addRemoved(const QString& mod);
+
+    // Whether entry() would have anything to say
+    [[nodiscard]] bool isEmpty() const;
+
+    void clear();
+
+    // A markdown list item such as "- **2026-10-18 14:02** enabled `A`, `B`; moved 500 plugins (`C`, ...)"
+    [[nodiscard]] QString entry(const QDateTime& time) const;
+
+private:
+    struct Change {
+        bool wasEnabled  = false;
+        bool isEnabled   = false;
+        bool stateKnown  = false; // the state changed at least once
+        int fromPriority = -1;
+        int toPriority   = -1;
+    };
+
+    QMap<QString, Change> m_changes[2]; // by kind, sorted by name so entries read the same however events arrived
+    QSet<QString> m_installed;
+    QSet<QString> m_removed;
+};
@@ -0,0 +1,101 @@
+#include "CompletionIndex.h"
+
+#include <QSet>
+
+#include <algorithm>
+
+QStringView CompletionIndex::keyText(const Key& key) const
+{
+    return QStringView(m_names[key.id].folded).mid(key.offset);
+}
+
+bool CompletionIndex::keyLess(const Key& a, const Key& b) const
+{
+    const int order = keyText(a).compare(keyText(b));
+    if (order != 0) {
+        return order < 0;
+    }
+    return a.offset != b.offset ? a.offset < b.offset : a.id < b.id;
+}
+
+bool CompletionIndex::setNames(const Kind kind, const QStringList& names)
+{
+    QHash<QString, int>& ids = m_ids[static_cast<int>(kind)];
+
+    const QSet<QString> wanted(names.cbegin(), names.cend());
+    QSet<int> removed;
+    for (auto it = ids.begin(); it != ids.end();) {
+        if (wanted.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        removed.insert(*it);
+        m_names[*it].folded.clear();
+        m_freeIds.append(*it);
+        it = ids.erase(it);
+    }
+    if (!removed.isEmpty()) {
+        m_keys.removeIf([&removed](const Key& key) { return removed.contains(key.id); });
+    }
+
+    const qsizetype oldKeys = m_keys.size();
+    for (const QString& name : wanted) {
+        if (name.isEmpty() || ids.contains(name)) {
+            continue;
+        }
+        int id = 0;
+        if (m_freeIds.isEmpty()) {
+            id = static_cast<int>(m_names.size());
+            m_names.append({});
+        } else {
+            id = m_freeIds.takeLast();
+        }
+        m_names[id] = { name, name.toCaseFolded(), kind };
+        ids.insert(name, id);
+
+        // Whole name, then every word in it
+        const QString& folded = m_names[id].folded;
+        m_keys.append({ id, 0 });
+        for (int i = 1; i < folded.size(); ++i) {
+            if (folded[i].isLetterOrNumber() && !folded[i - 1].isLetterOrNumber()) {
+                m_keys.append({ id, i });
+            }
+        }
+    }
+
+    if (m_keys.size() == oldKeys) {
+        return !removed.isEmpty();
+    }
+    const auto less = [this](const Key& a, const Key& b) { return keyLess(a, b); };
+    std::sort(m_keys.begin() + oldKeys, m_keys.end(), less);
+    std::inplace_merge(m_keys.begin(), m_keys.begin() + oldKeys, m_keys.end(), less);
+    return true;
+}
+
+QList<CompletionIndex::Completion> CompletionIndex::complete(const QString& prefix, const qsizetype limit) const
+{
+    const QString folded = prefix.toCaseFolded();
+    if (folded.isEmpty() || limit <= 0) {
+        return {};
+    }
+
+    const auto first = std::lower_bound(m_keys.cbegin(), m_keys.cend(), folded,
+        [this](const Key& key, const QString& text) { return keyText(key).compare(text) < 0; });
+    auto last = first;
+    while (last != m_keys.cend() && keyText(*last).startsWith(folded)) {
+        ++last;
+    }
+
+    // Whole-name matches first, then names with a later word matching
+    QList<Completion> result;
+    QSet<int> seen;
+    for (const bool wholeName : { true, false }) {
+        for (auto it = first; it != last && result.size() < limit; ++it) {
+            if ((it->offset == 0) == wholeName && !seen.contains(it->id)) {
+                seen.insert(it->id);
+                result.append({ m_names[it->id].name, m_names[it->id].kind });
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// Mod and plugin names indexed under each of their words, sorted, for prefix completion in the editor
+class CompletionIndex {
+public:
+    enum class Kind {
+        Mod,
+        Plugin,
+    };
+
+    struct Completion {
+        QString name;
+        Kind kind = Kind::Mod;
+    };
+
+    // Replaces the names of a kind; returns whether any changed
+    bool setNames(Kind kind, const QStringList& names);
+
+    // Up to limit names with a word starting with prefix, ignoring case; names that start with it come first
+    [[nodiscard]] QList<Completion> complete(const QString& prefix, qsizetype limit) const;
+
+private:
+    struct Name {
+        QString name;
+        QString folded; // empty once removed
+        Kind kind = Kind::Mod;
+    };
+
+    struct Key {
+        int id     = 0; // into m_names
+        int offset = 0; // where the word starts in the folded name
+    };
+
+    [[nodiscard]] QStringView keyText(const Key& key) const;
+    [[nodiscard]] bool keyLess(const Key& a, const Key& b) const;
+
+    QList<Name> m_names;           // by id
+    QList<int> m_freeIds;          // ids of removed names, for reuse
+    QHash<QString, int> m_ids[2];  // by kind, name -> id
+    QList<Key> m_keys;             // every word of every name, sorted by keyText()
+};
@@ -0,0 +1,138 @@
+#include "FuzzyMatcher.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+constexpr int NO_MATCH = std::numeric_limits<int>::min();
+
+// Score parts
+constexpr int MATCHED     = 16; // per matched character
+constexpr int WORD_START  = 12; // matched character that starts a word
+constexpr int CONSECUTIVE = 8;  // matched character right after the previous one
+constexpr int GAP         = 1;  // per skipped character within the match
+constexpr int MAX_SLACK   = 32; // characters outside the match beyond this cost nothing more
+
+bool isWordCharacter(const char16_t c) { return QChar(c).isLetterOrNumber(); }
+}
+
+FuzzyMatcher::FuzzyMatcher(const QStringList& candidates)
+{
+    qsizetype length = 0;
+    for (const QString& candidate : candidates) {
+        length += candidate.size();
+    }
+    m_buffer.reserve(length);
+    m_starts.reserve(candidates.size() + 1);
+    m_masks.reserve(candidates.size());
+
+    for (const QString& candidate : candidates) {
+        m_starts.append(m_buffer.size());
+        const QString folded = candidate.toCaseFolded();
+        quint64 mask         = 0;
+        for (const QChar c : folded) {
+            mask |= charMask(c.unicode());
+        }
+        m_buffer.append(folded);
+        m_masks.append(mask);
+    }
+    m_starts.append(m_buffer.size());
+}
+
+quint64 FuzzyMatcher::charMask(const char16_t c)
+{
+    if (c >= u'a' && c <= u'z') {
+        return quint64(1) << (c - u'a');
+    }
+    if (c >= u'0' && c <= u'9') {
+        return quint64(1) << (26 + c - u'0');
+    }
+    return quint64(1) << (36 + c % 28); // everything else shares the remaining bits
+}
+
+int FuzzyMatcher::score(const qsizetype candidate, const char16_t* query, const qsizetype queryLength) const
+{
+    const char16_t* const text = reinterpret_cast<const char16_t*>(m_buffer.constData()) + m_starts[candidate];
+    const qsizetype length     = m_starts[candidate + 1] - m_starts[candidate];
+
+    // The first place where the whole query has been seen in order...
+    qsizetype end = -1;
+    for (qsizetype i = 0, q = 0; i < length; ++i) {
+        if (text[i] == query[q] && ++q == queryLength) {
+            end = i;
+            break;
+        }
+    }
+    if (end < 0) {
+        return NO_MATCH;
+    }
+
+    // ...and walking back from there, the latest start, so the match is as tight as it gets
+    qsizetype start = end;
+    for (qsizetype i = end, q = queryLength - 1; i >= 0; --i) {
+        if (text[i] == query[q] && q-- == 0) {
+            start = i;
+            break;
+        }
+    }
+
+    int result   = 0;
+    bool chained = false;
+    for (qsizetype i = start, q = 0; i <= end; ++i) {
+        if (text[i] != query[q]) {
+            result -= GAP;
+            chained = false;
+            continue;
+        }
+        result += MATCHED;
+        if (i == 0 || !isWordCharacter(text[i - 1])) {
+            result += WORD_START;
+        }
+        if (chained) {
+            result += CONSECUTIVE;
+        }
+        chained = true;
+        ++q;
+    }
+
+    // Of otherwise equal matches, the one in the shorter candidate is likely the one meant
+    return result - static_cast<int>(std::min<qsizetype>(length - (end - start + 1), MAX_SLACK)) / 4;
+}
+
+QList<FuzzyMatcher::Match> FuzzyMatcher::match(
+    const QString& query, const qsizetype limit, const std::atomic_bool* cancelled) const
+{
+    QString folded = query.toCaseFolded();
+    folded.removeIf([](const QChar c) { return c.isSpace(); });
+    if (folded.isEmpty() || limit <= 0) {
+        return {};
+    }
+
+    quint64 queryMask = 0;
+    for (const QChar c : folded) {
+        queryMask |= charMask(c.unicode());
+    }
+    const auto* const queryText = reinterpret_cast<const char16_t*>(folded.constData());
+
+    QList<Match> matches;
+    for (qsizetype candidate = 0; candidate < m_masks.size(); ++candidate) {
+        if (candidate % CANCEL_CHECK_INTERVAL == 0 && cancelled != nullptr
+            && cancelled->load(std::memory_order_relaxed)) {
+            return {};
+        }
+        if ((m_masks[candidate] & queryMask) != queryMask) {
+            continue;
+        }
+        if (const int points = score(candidate, queryText, folded.size()); points != NO_MATCH) {
+            matches.append({ static_cast<int>(candidate), points });
+        }
+    }
+
+    const auto better = [](const Match& a, const Match& b) {
+        return a.score != b.score ? a.score > b.score : a.candidate < b.candidate;
+    };
+    const qsizetype kept = std::min(limit, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + kept, matches.end(), better);
+    matches.resize(kept);
+    return matches;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+
+// Fuzzy matching for the quick-open palette, over candidates packed into one buffer; immutable once built
+class FuzzyMatcher {
+public:
+    struct Match {
+        int candidate = 0;
+        int score     = 0;
+    };
+
+    explicit FuzzyMatcher(const QStringList& candidates);
+
+    [[nodiscard]] qsizetype size() const { return m_masks.size(); }
+
+    // The best limit matches, best first, ties in candidate order. Whitespace in query is ignored.
+    // Returns nothing if cancelled becomes set while matching.
+    [[nodiscard]] QList<Match> match(
+        const QString& query, qsizetype limit, const std::atomic_bool* cancelled = nullptr) const;
+
+private:
+    static constexpr qsizetype CANCEL_CHECK_INTERVAL = 4096; // candidates scored between checks
+
+    [[nodiscard]] static quint64 charMask(char16_t c);
+    [[nodiscard]] int score(qsizetype candidate, const char16_t* query, qsizetype queryLength) const;
+
+    QString m_buffer;          // all candidates, case-folded, back to back
+    QList<qsizetype> m_starts; // offset of every candidate in m_buffer, and the end
+    QList<quint64> m_masks;    // characters each candidate contains, see charMask()
+};
@@ -0,0 +1,240 @@
+#include "HistoryStore.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <algorithm>
+
+namespace {
+constexpr auto INDEX_FILE = "index.json";
+
+QByteArray encodeDelta(const QString& before, const QString& after)
+{
+    qsizetype prefix = 0;
+    const qsizetype shorter = std::min(before.size(), after.size());
+    while (prefix < shorter && before[prefix] == after[prefix]) {
+        ++prefix;
+    }
+    qsizetype suffix = 0;
+    while (suffix < shorter - prefix && before[before.size() - 1 - suffix] == after[after.size() - 1 - suffix]) {
+        ++suffix;
+    }
+
+    QByteArray delta;
+    QDataStream stream(&delta, QIODevice::WriteOnly);
+    stream << static_cast<qint64>(prefix) << static_cast<qint64>(suffix)
+           << after.mid(prefix, after.size() - prefix - suffix);
+    return delta;
+}
+
+std::optional<QString> applyDelta(const QString& before, const QByteArray& delta)
+{
+    QDataStream stream(delta);
+    qint64 prefix = 0;
+    qint64 suffix = 0;
+    QString middle;
+    stream >> prefix >> suffix >> middle;
+    if (stream.status() != QDataStream::Ok || prefix < 0 || suffix < 0 || prefix + suffix > before.size()) {
+        return std::nullopt;
+    }
+    return before.left(prefix) + middle + before.right(suffix);
+}
+}
+
+HistoryStore::HistoryStore(const QString& directory)
+    : m_directory(directory)
+{
+}
+
+void HistoryStore::loadIndex()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+
+    QFile file(m_directory + "/" + INDEX_FILE);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    for (const QJsonValue& value : QJsonDocument::fromJson(file.readAll()).array()) {
+        const QJsonObject object = value.toObject();
+        m_versions.append({ object["id"].toInt(),
+            QDateTime::fromMSecsSinceEpoch(object["time"].toInteger()), object["keyframe"].toBool(),
+            object["length"].toInteger(), object["bytes"].toInteger() });
+    }
+
+    // A history that does not start with a keyframe cannot be reconstructed
+    while (!m_versions.isEmpty() && !m_versions.first().keyframe) {
+        m_versions.removeFirst();
+    }
+}
+
+void HistoryStore::saveIndex() const
+{
+    QJsonArray array;
+    for (const Version& version : m_versions) {
+        array.append(QJsonObject { { "id", version.id }, { "time", version.time.toMSecsSinceEpoch() },
+            { "keyframe", version.keyframe }, { "length", version.length }, { "bytes", version.bytes } });
+    }
+
+    QSaveFile file(m_directory + "/" + INDEX_FILE);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(array).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+}
+
+QString HistoryStore::payloadPath(const Version& version) const
+{
+    return QString("%1/%2.%3").arg(m_directory).arg(version.id).arg(version.keyframe ? "full" : "delta");
+}
+
+qint64 HistoryStore::writePayload(const Version& version, const QByteArray& payload) const
+{
+    const QByteArray compressed = qCompress(payload);
+    QSaveFile file(payloadPath(version));
+    if (!file.open(QIODevice::WriteOnly) || file.write(compressed) != compressed.size() || !file.commit()) {
+        return -1;
+    }
+    return compressed.size();
+}
+
+std::optional<QString> HistoryStore::reconstruct(const qsizetype index) const
+{
+    if (index < 0 || index >= m_versions.size()) {
+        return std::nullopt;
+    }
+
+    // Start from the closest keyframe at or before the version
+    qsizetype keyframe = index;
+    while (keyframe > 0 && !m_versions[keyframe].keyframe) {
+        --keyframe;
+    }
+
+    std::optional<QString> text;
+    for (qsizetype i = keyframe; i <= index; ++i) {
+        QFile file(payloadPath(m_versions[i]));
+        if (!file.open(QIODevice::ReadOnly)) {
+            return std::nullopt;
+        }
+        const QByteArray payload = qUncompress(file.readAll());
+        if (m_versions[i].keyframe) {
+            text = QString::fromUtf8(payload);
+        } else if (text.has_value()) {
+            text = applyDelta(*text, payload);
+        }
+        if (!text.has_value()) {
+            return std::nullopt;
+        }
+    }
+    return text;
+}
+
+void HistoryStore::record(const QString& text)
+{
+    QMutexLocker lock(&m_mutex);
+    loadIndex();
+
+    if (!m_versions.isEmpty() && !m_newestText.has_value()) {
+        m_newestText = reconstruct(m_versions.size() - 1);
+    }
+    if (m_newestText.has_value() && *m_newestText == text) {
+        return;
+    }
+
+    QDir().mkpath(m_directory);
+
+    Version version;
+    version.id     = m_versions.isEmpty() ? 1 : m_versions.last().id + 1;
+    version.time   = QDateTime::currentDateTime();
+    version.length = text.size();
+    // A keyframe every KEYFRAME_INTERVAL versions, or whenever the previous text is unavailable
+    qsizetype sinceKeyframe = 0;
+    while (sinceKeyframe < m_versions.size() && !m_versions[m_versions.size() - 1 - sinceKeyframe].keyframe) {
+        ++sinceKeyframe;
+    }
+    version.keyframe = !m_newestText.has_value() || sinceKeyframe + 1 >= KEYFRAME_INTERVAL;
+
+    const QByteArray payload = version.keyframe ? text.toUtf8() : encodeDelta(*m_newestText, text);
+    version.bytes            = writePayload(version, payload);
+    if (version.bytes < 0) {
+        return;
+    }
+
+    m_versions.append(version);
+    m_newestText = text;
+    saveIndex();
+}
+
+QList<HistoryStore::Version> HistoryStore::versions()
+{
+    QMutexLocker lock(&m_mutex);
+    loadIndex();
+    return m_versions;
+}
+
+std::optional<QString> HistoryStore::text(const int id)
+{
+    QMutexLocker lock(&m_mutex);
+    loadIndex();
+
+    const auto it = std::find_if(
+        m_versions.cbegin(), m_versions.cend(), [id](const Version& version) { return version.id == id; });
+    if (it == m_versions.cend()) {
+        return std::nullopt;
+    }
+    if (it + 1 == m_versions.cend() && m_newestText.has_value()) {
+        return m_newestText;
+    }
+    return reconstruct(it - m_versions.cbegin());
+}
+
+void HistoryStore::prune(const int maxAgeDays, const qint64 sizeBudget)
+{
+    QMutexLocker lock(&m_mutex);
+    loadIndex();
+
+    const QDateTime cutoff = QDateTime::currentDateTime().addDays(-maxAgeDays);
+    qint64 total           = 0;
+    for (const Version& version : m_versions) {
+        total += version.bytes;
+    }
+
+    qsizetype drop = 0;
+    while (drop < m_versions.size() - 1 && (m_versions[drop].time < cutoff || total > sizeBudget)) {
+        total -= m_versions[drop].bytes;
+        ++drop;
+    }
+    if (drop == 0) {
+        return;
+    }
+
+    // The new oldest version has to become a keyframe before its base goes away
+    Version& first = m_versions[drop];
+    if (!first.keyframe) {
+        const std::optional<QString> text = reconstruct(drop);
+        if (!text.has_value()) {
+            return;
+        }
+        Version keyframe  = first;
+        keyframe.keyframe = true;
+        keyframe.bytes    = writePayload(keyframe, text->toUtf8());
+        if (keyframe.bytes < 0) {
+            return;
+        }
+        QFile::remove(payloadPath(first));
+        first = keyframe;
+    }
+
+    for (qsizetype i = 0; i < drop; ++i) {
+        QFile::remove(payloadPath(m_versions[i]));
+    }
+    m_versions.remove(0, drop);
+    saveIndex();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QDateTime>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+#include <optional>
+
+// Version history of a profile's notes as deltas with periodic full keyframes; thread-safe, does file I/O
+class HistoryStore {
+public:
+    static constexpr int KEYFRAME_INTERVAL = 16;
+
+    struct Version {
+        int id = 0;
+        QDateTime time;
+        bool keyframe  = false;
+        qint64 length  = 0; // characters in the reconstructed text
+        qint64 bytes   = 0; // bytes used on disk
+    };
+
+    explicit HistoryStore(const QString& directory);
+
+    // Records text as the newest version unless it equals the current newest one
+    void record(const QString& text);
+
+    // Oldest first
+    [[nodiscard]] QList<Version> versions();
+
+    [[nodiscard]] std::optional<QString> text(int id);
+
+    // Drops the oldest versions that are older than maxAgeDays or exceed the size budget.
+    // The newest version is always kept.
+    void prune(int maxAgeDays, qint64 sizeBudget);
+
+private:
+    void loadIndex();
+    void saveIndex() const;
+    [[nodiscard]] std::optional<QString> reconstruct(qsizetype index) const;
+    [[nodiscard]] QString payloadPath(const Version& version) const;
+    [[nodiscard]] qint64 writePayload(const Version& version, const QByteArray& payload) const;
+
+    QString m_directory;
+    QMutex m_mutex;
+    bool m_loaded = false;
+    QList<Version> m_versions;
+    std::optional<QString> m_newestText; // text of m_versions.last(), once known
+};
@@ -0,0 +1,173 @@
+#include "LineDiff.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+struct Range {
+    const QStringList& lines;
+    qsizetype offset;
+    int size;
+
+    const QString& operator[](const int i) const { return lines[offset + i]; }
+    [[nodiscard]] Range mid(const int from, const int to) const { return { lines, offset + from, to - from }; }
+};
+
+// a[x, u) == b[y, v), on the middle of an edit path of d edits
+struct Snake {
+    int x;
+    int y;
+    int u;
+    int v;
+    int d;
+};
+
+/**
+ * Finds the middle snake by running the search forward from the start and
+ * backward from the end until the two meet (Myers, section 4b), looking at
+ * most maxD edits each way. forward and backward are scratch space for the
+ * furthest x on each diagonal, shared by all levels of the recursion.
+ */
+bool middleSnake(const Range& a, const Range& b, const int maxD, std::vector<int>& forward,
+    std::vector<int>& backward, Snake& snake)
+{
+    const int n      = a.size;
+    const int m      = b.size;
+    const int delta  = n - m;
+    const bool odd   = (delta & 1) != 0;
+    const int center = maxD + 1;
+    const int limit  = std::min((n + m + 1) / 2, maxD);
+    const auto fv    = [&forward, center](const int k) -> int& { return forward[center + k]; };
+    const auto bv    = [&backward, center](const int k) -> int& { return backward[center + k]; };
+    fv(1) = 0;
+    bv(1) = 0;
+
+    for (int d = 0; d <= limit; ++d) {
+        for (int k = -d; k <= d; k += 2) {
+            int x        = (k == -d || (k != d && fv(k - 1) < fv(k + 1))) ? fv(k + 1) : fv(k - 1) + 1;
+            int y        = x - k;
+            const int x0 = x;
+            const int y0 = y;
+            while (x < n && y < m && a[x] == b[y]) {
+                ++x;
+                ++y;
+            }
+            fv(k) = x;
+            // Diagonal k forward is diagonal delta - k backward, where the backward search is one round behind
+            if (odd && delta - k >= -(d - 1) && delta - k <= d - 1 && x + bv(delta - k) >= n) {
+                snake = { x0, y0, x, y, 2 * d - 1 };
+                return true;
+            }
+        }
+
+        // Backward, x and y count from the ends of the ranges
+        for (int k = -d; k <= d; k += 2) {
+            int x        = (k == -d || (k != d && bv(k - 1) < bv(k + 1))) ? bv(k + 1) : bv(k - 1) + 1;
+            int y        = x - k;
+            const int x0 = x;
+            const int y0 = y;
+            while (x < n && y < m && a[n - 1 - x] == b[m - 1 - y]) {
+                ++x;
+                ++y;
+            }
+            bv(k) = x;
+            if (!odd && delta - k >= -d && delta - k <= d && x + fv(delta - k) >= n) {
+                snake = { n - x, m - y, n - x0, m - y0, 2 * d };
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void appendAll(const Range& range, const LineDiff::Op op, QList<LineDiff::Line>& result)
+{
+    for (int i = 0; i < range.size; ++i) {
+        result.append({ op, range[i] });
+    }
+}
+
+// Appends the edit script for a -> b to result, splitting at middle snakes, so it takes linear space
+void divide(const Range& a, const Range& b, const int maxD, std::vector<int>& forward, std::vector<int>& backward,
+    QList<LineDiff::Line>& result)
+{
+    // Without a common first or last line, two ranges that are not empty are at least two edits apart, and both
+    // halves of the split have fewer edits than the whole
+    int prefix = 0;
+    while (prefix < a.size && prefix < b.size && a[prefix] == b[prefix]) {
+        ++prefix;
+    }
+    int suffix = 0;
+    while (suffix < a.size - prefix && suffix < b.size - prefix
+        && a[a.size - 1 - suffix] == b[b.size - 1 - suffix]) {
+        ++suffix;
+    }
+    appendAll(a.mid(0, prefix), LineDiff::Op::Equal, result);
+
+    const Range middleA = a.mid(prefix, a.size - suffix);
+    const Range middleB = b.mid(prefix, b.size - suffix);
+    Snake snake {};
+    if (middleA.size == 0 || middleB.size == 0 || !middleSnake(middleA, middleB, maxD, forward, backward, snake)) {
+        appendAll(middleA, LineDiff::Op::Delete, result);
+        appendAll(middleB, LineDiff::Op::Insert, result);
+    } else {
+        divide(middleA.mid(0, snake.x), middleB.mid(0, snake.y), maxD, forward, backward, result);
+        appendAll(middleA.mid(snake.x, snake.u), LineDiff::Op::Equal, result);
+        divide(middleA.mid(snake.u, middleA.size), middleB.mid(snake.v, middleB.size), maxD, forward, backward,
+            result);
+    }
+
+    appendAll(a.mid(a.size - suffix, a.size), LineDiff::Op::Equal, result);
+}
+
+// Appends the edit script for a -> b to result, or returns false if it needs more than maxEdits edits
+bool myers(const Range& a, const Range& b, const int maxEdits, QList<LineDiff::Line>& result)
+{
+    // The first split sees the whole distance; every later one sees less
+    const int maxD = (std::min(a.size + b.size, maxEdits) + 1) / 2;
+    std::vector<int> forward(2 * maxD + 3, 0);
+    std::vector<int> backward(2 * maxD + 3, 0);
+    Snake snake {};
+    if (a.size > 0 && b.size > 0
+        && (!middleSnake(a, b, maxD, forward, backward, snake) || snake.d > maxEdits)) {
+        return false;
+    }
+    divide(a, b, maxD, forward, backward, result);
+    return true;
+}
+}
+
+QList<LineDiff::Line> LineDiff::diff(const QStringList& before, const QStringList& after, const int maxEdits)
+{
+    QList<Line> result;
+
+    qsizetype prefix = 0;
+    while (prefix < before.size() && prefix < after.size() && before[prefix] == after[prefix]) {
+        ++prefix;
+    }
+    qsizetype suffix = 0;
+    while (suffix < before.size() - prefix && suffix < after.size() - prefix
+        && before[before.size() - 1 - suffix] == after[after.size() - 1 - suffix]) {
+        ++suffix;
+    }
+
+    for (qsizetype i = 0; i < prefix; ++i) {
+        result.append({ Op::Equal, before[i] });
+    }
+
+    const Range a { before, prefix, static_cast<int>(before.size() - prefix - suffix) };
+    const Range b { after, prefix, static_cast<int>(after.size() - prefix - suffix) };
+    if (!myers(a, b, maxEdits, result)) {
+        for (int i = 0; i < a.size; ++i) {
+            result.append({ Op::Delete, a[i] });
+        }
+        for (int i = 0; i < b.size; ++i) {
+            result.append({ Op::Insert, b[i] });
+        }
+    }
+
+    for (qsizetype i = after.size() - suffix; i < after.size(); ++i) {
+        result.append({ Op::Equal, after[i] });
+    }
+    return result;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QList>
+#include <QStringList>
+
+// Line-based linear-space Myers diff, after trimming the common prefix and suffix
+namespace LineDiff {
+
+enum class Op {
+    Equal,
+    Insert,
+    Delete,
+};
+
+struct Line {
+    Op op;
+    QString text;
+};
+
+// Edit script turning before into after. If the two differ by more than maxEdits
+// lines, the differing middle is reported as one deletion followed by one insertion.
+QList<Line> diff(const QStringList& before, const QStringList& after, int maxEdits = 4000);
+
+}
@@ -0,0 +1,192 @@
+#include "LinkChecker.h"
+#include "AttachmentStore.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QUrl>
+
+#include <algorithm>
+
+namespace {
+void addFile(
+    QList<LinkChecker::Reference>& references, QString target, const QString& profilePath, const QString& attachments)
+{
+    static const QRegularExpression schemeRe(R"(^([a-z][a-z0-9+.-]+):)", QRegularExpression::CaseInsensitiveOption);
+
+    target = target.trimmed();
+    if (target.startsWith(u"./")) {
+        target.remove(0, 2);
+    }
+    if (target.isEmpty() || target.startsWith(u'#')) {
+        return;
+    }
+
+    // A single letter before the colon is a drive, not a scheme
+    QString path;
+    if (const QRegularExpressionMatch scheme = schemeRe.match(target); scheme.hasMatch()) {
+        const QString name = scheme.captured(1).toLower();
+        const QUrl url(target);
+        if (name == "file") {
+            path = url.toLocalFile();
+        } else if (name == "notes-img" && url.host() == "profile") {
+            path = profilePath + url.path();
+        } else if (name == "notes-img" && url.host() == "attachments") {
+            path = attachments + url.path();
+        } else {
+            return;
+        }
+    } else {
+        // The query and fragment do not name the file
+        qsizetype end = target.size();
+        for (const QChar c : { u'?', u'#' }) {
+            if (const qsizetype at = target.indexOf(c); at >= 0) {
+                end = std::min(end, at);
+            }
+        }
+        path = QDir::fromNativeSeparators(QUrl::fromPercentEncoding(target.left(end).toUtf8()));
+        if (QDir::isRelativePath(path)) {
+            path = profilePath + "/" + path;
+        }
+    }
+    references.append({ LinkChecker::Reference::Kind::File, target, QDir::cleanPath(path) });
+}
+
+// Blanks text[from, from + length), so later patterns do not match inside it
+void blank(QString& text, const qsizetype from, const qsizetype length)
+{
+    text.replace(from, length, QString(length, u' '));
+}
+
+// Windows paths are case-insensitive
+QSet<QString> listing(const QString& directory)
+{
+    QSet<QString> names;
+    for (const QString& name :
+        QDir(directory).entryList(QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot)) {
+        names.insert(name.toCaseFolded());
+    }
+    return names;
+}
+}
+
+QList<LinkChecker::Reference> LinkChecker::extract(const QString& markdown, const QString& profilePath) const
+{
+    static const QRegularExpression fenceRe(R"(^\s{0,3}(`{3,}|~{3,}))");
+    static const QRegularExpression codeSpanRe(R"((`+)(.+?)\1)");
+    static const QRegularExpression linkRe(R"(\]\(\s*(?:<([^>]*)>|([^\s()]+))(?:\s+(?:"[^"]*"|'[^']*'))?\s*\))");
+    static const QRegularExpression definitionRe(R"(^\s{0,3}\[[^\]]+\]:\s*(?:<([^>]*)>|(\S+)))");
+    static const QRegularExpression urlRe(R"([a-z][a-z0-9+.-]*://\S+)", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression pluginRe(
+        R"((?<![\w.'&+-])[\w.'&+-]+\.(?:esp|esm|esl)(?!\w|\.\w))", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression codePluginRe(
+        R"(^[^`/\\:*?"<>|]+\.(?:esp|esm|esl)$)", QRegularExpression::CaseInsensitiveOption);
+
+    const QString attachments = AttachmentStore::rootForProfile(profilePath);
+    QList<Reference> references;
+    QString fence; // opening marker of the fenced block being skipped
+    for (const QStringView line : QStringView(markdown).split(u'\n')) {
+        const QRegularExpressionMatch fenceMatch = fenceRe.matchView(line);
+        if (!fence.isEmpty()) {
+            if (fenceMatch.hasMatch() && fenceMatch.capturedView(1).front() == fence.front()
+                && fenceMatch.capturedLength(1) >= fence.size()) {
+                fence.clear();
+            }
+            continue;
+        }
+        if (fenceMatch.hasMatch()) {
+            fence = fenceMatch.captured(1);
+            continue;
+        }
+
+        // Inline code is blanked out, except that a span holding nothing but a plugin name refers to it
+        QString text = line.toString();
+        for (auto it = codeSpanRe.globalMatch(text); it.hasNext();) {
+            const QRegularExpressionMatch match = it.next();
+            const QString code                  = match.captured(2).trimmed();
+            if (codePluginRe.match(code).hasMatch()) {
+                references.append({ Reference::Kind::Plugin, code, code.toCaseFolded() });
+            }
+            blank(text, match.capturedStart(), match.capturedLength());
+        }
+
+        for (auto it = linkRe.globalMatch(text); it.hasNext();) {
+            const QRegularExpressionMatch match = it.next();
+            const int group                     = match.hasCaptured(1) ? 1 : 2;
+            addFile(references, match.captured(group), profilePath, attachments);
+            blank(text, match.capturedStart(group), match.capturedLength(group));
+        }
+        if (const QRegularExpressionMatch match = definitionRe.match(text); match.hasMatch()) {
+            const int group = match.hasCaptured(1) ? 1 : 2;
+            addFile(references, match.captured(group), profilePath, attachments);
+            blank(text, match.capturedStart(group), match.capturedLength(group));
+        }
+        for (auto it = urlRe.globalMatch(text); it.hasNext();) {
+            const QRegularExpressionMatch match = it.next();
+            blank(text, match.capturedStart(), match.capturedLength());
+        }
+
+        // A bare name only reaches back to the last space, so the installed names, which may hold spaces, go first
+        for (const ModMentionIndex::Mention& mention : m_pluginMentions.mentionsIn(text)) {
+            blank(text, mention.from, mention.length);
+        }
+        for (auto it = pluginRe.globalMatch(text); it.hasNext();) {
+            const QString name = it.next().captured();
+            references.append({ Reference::Kind::Plugin, name, name.toCaseFolded() });
+        }
+    }
+    return references;
+}
+
+void LinkChecker::setPluginNames(const QStringList& names)
+{
+    m_plugins.clear();
+    for (const QString& name : names) {
+        m_plugins.insert(name.toCaseFolded());
+    }
+    m_pluginMentions.setModNames(names, nullptr);
+}
+
+QList<LinkChecker::Reference> LinkChecker::check(const QList<Reference>& references)
+{
+    // Keep the results that are recent enough; the other paths are grouped by directory to be listed
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QHash<QString, Probe> probes;
+    QHash<QString, QStringList> pending; // directory -> names in it
+    for (const Reference& reference : references) {
+        if (reference.kind != Reference::Kind::File || probes.contains(reference.key)) {
+            continue;
+        }
+        const auto it = m_probes.constFind(reference.key);
+        if (it != m_probes.cend() && now - it->time < RECHECK_AFTER) {
+            probes.insert(reference.key, *it);
+            continue;
+        }
+        probes.insert(reference.key, { false, now });
+        const qsizetype slash = reference.key.lastIndexOf(u'/');
+        pending[reference.key.left(slash)].append(reference.key.mid(slash + 1));
+    }
+
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it) {
+        const QSet<QString> names = listing(it.key());
+        for (const QString& name : *it) {
+            // A drive root has no name in its parent
+            const QString path  = it.key() + "/" + name;
+            probes[path].exists = name.isEmpty() ? QFileInfo::exists(path) : names.contains(name.toCaseFolded());
+        }
+    }
+    m_probes = std::move(probes);
+
+    QList<Reference> broken;
+    QSet<QString> seen;
+    for (const Reference& reference : references) {
+        const bool resolved = reference.kind == Reference::Kind::File ? m_probes.value(reference.key).exists
+                                                                      : m_plugins.contains(reference.key);
+        if (!resolved && !seen.contains(reference.target)) {
+            seen.insert(reference.target);
+            broken.append(reference);
+        }
+    }
+    return broken;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ModMentionIndex.h"
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+// Finds links to missing local files and plugin names that are not installed; not thread-safe, run on one worker
+class LinkChecker {
+public:
+    static constexpr qint64 RECHECK_AFTER = 30 * 1000; // ms a probe result is trusted
+
+    struct Reference {
+        enum class Kind {
+            File,
+            Plugin,
+        };
+
+        Kind kind;
+        QString target; // as written, without angle brackets or a leading "./"
+        QString key;    // the absolute path, or the case-folded plugin name
+    };
+
+    // References outside code blocks; relative paths are resolved against the profile directory. Plugin names in
+    // the text are only those not part of an installed one.
+    [[nodiscard]] QList<Reference> extract(const QString& markdown, const QString& profilePath) const;
+
+    void setPluginNames(const QStringList& names);
+
+    // The references that do not resolve, in the order given and without repeating a target
+    [[nodiscard]] QList<Reference> check(const QList<Reference>& references);
+
+private:
+    struct Probe {
+        bool exists = false;
+        qint64 time = 0; // ms since the epoch
+    };
+
+    QHash<QString, Probe> m_probes; // by path, for the paths of the last pass
+    QSet<QString> m_plugins;        // case-folded names
+    ModMentionIndex m_pluginMentions;
+};
@@ -0,0 +1,218 @@
+#include "LoadOrder.h"
+
+#include <QHash>
+#include <QLocale>
+
+#include <algorithm>
+
+namespace {
+constexpr auto BEGIN_MARKER = "<!-- load-order-snapshot ";
+constexpr auto END_MARKER   = "<!-- /load-order-snapshot -->";
+
+QString escapeCell(QString text) { return text.replace('\\', "\\\\").replace('|', "\\|"); }
+
+// Cells of a table row, unescaped; the leading and trailing pipes are optional
+QStringList splitRow(const QStringView line)
+{
+    QStringList cells;
+    QString cell;
+    for (qsizetype i = 0; i < line.size(); ++i) {
+        if (line[i] == u'\\' && i + 1 < line.size()) {
+            cell.append(line[++i]);
+        } else if (line[i] == u'|') {
+            cells.append(cell.trimmed());
+            cell.clear();
+        } else {
+            cell.append(line[i]);
+        }
+    }
+    cells.append(cell.trimmed());
+    if (line.trimmed().startsWith(u'|')) {
+        cells.removeFirst();
+    }
+    if (line.trimmed().endsWith(u'|') && !cells.isEmpty()) {
+        cells.removeLast();
+    }
+    return cells;
+}
+
+void appendTable(QString& markdown, const QString& column, const QList<LoadOrder::Entry>& entries)
+{
+    markdown += QString("| # | %1 | Enabled |\n|--:|---|:-:|\n").arg(column);
+    for (qsizetype i = 0; i < entries.size(); ++i) {
+        markdown += QString("| %1 | %2 | %3 |\n")
+                        .arg(i + 1)
+                        .arg(escapeCell(entries[i].name), entries[i].enabled ? QStringLiteral("✓") : QString());
+    }
+}
+
+// Longest strictly increasing subsequence by patience sorting; returns the positions in values that belong to it
+QList<bool> longestIncreasing(const QList<int>& values)
+{
+    QList<qsizetype> tails; // tails[k]: position of the smallest tail of an increasing run of length k + 1
+    QList<qsizetype> previous(values.size(), -1);
+    for (qsizetype i = 0; i < values.size(); ++i) {
+        const auto it = std::lower_bound(tails.cbegin(), tails.cend(), values[i],
+            [&values](const qsizetype position, const int value) { return values[position] < value; });
+        const qsizetype length = it - tails.cbegin();
+        previous[i]            = length > 0 ? tails[length - 1] : -1;
+        if (length == tails.size()) {
+            tails.append(i);
+        } else {
+            tails[length] = i;
+        }
+    }
+
+    QList<bool> kept(values.size(), false);
+    for (qsizetype i = tails.isEmpty() ? -1 : tails.last(); i >= 0; i = previous[i]) {
+        kept[i] = true;
+    }
+    return kept;
+}
+
+void appendList(QString& markdown, const QString& label, const QStringList& items)
+{
+    if (items.isEmpty()) {
+        return;
+    }
+    QStringList quoted;
+    quoted.reserve(items.size());
+    for (const QString& item : items) {
+        quoted.append("`" + item + "`");
+    }
+    markdown += QString("- %1: %2\n").arg(label, quoted.join(", "));
+}
+
+void appendDiff(QString& markdown, const QString& title, const LoadOrder::Diff& diff)
+{
+    markdown += QString("**%1**: ").arg(title);
+    if (diff.isEmpty()) {
+        markdown += "no changes\n\n";
+        return;
+    }
+    markdown += QString("%1 added, %2 removed, %3 moved, %4 enabled, %5 disabled\n\n")
+                    .arg(diff.added.size())
+                    .arg(diff.removed.size())
+                    .arg(diff.moved.size())
+                    .arg(diff.enabled.size())
+                    .arg(diff.disabled.size());
+
+    appendList(markdown, "Added", diff.added);
+    appendList(markdown, "Removed", diff.removed);
+    QStringList moved;
+    moved.reserve(diff.moved.size());
+    for (const LoadOrder::Move& move : diff.moved) {
+        moved.append(QString("%1 (%2 → %3)").arg(move.name, QString::number(move.from), QString::number(move.to)));
+    }
+    appendList(markdown, "Moved", moved);
+    appendList(markdown, "Enabled", diff.enabled);
+    appendList(markdown, "Disabled", diff.disabled);
+    markdown += "\n";
+}
+}
+
+QString LoadOrder::toMarkdown(const Snapshot& snapshot)
+{
+    QString markdown = BEGIN_MARKER + snapshot.time.toString(Qt::ISODate) + " -->\n";
+    markdown += QString("### Load Order, %1\n\n").arg(QLocale().toString(snapshot.time, QLocale::ShortFormat));
+    appendTable(markdown, "Plugin", snapshot.plugins);
+    markdown += "\n";
+    appendTable(markdown, "Mod", snapshot.mods);
+    markdown += END_MARKER;
+    markdown += "\n";
+    return markdown;
+}
+
+std::optional<LoadOrder::Snapshot> LoadOrder::findLast(const QString& markdown)
+{
+    const qsizetype begin = markdown.lastIndexOf(BEGIN_MARKER);
+    if (begin < 0) {
+        return std::nullopt;
+    }
+    qsizetype end = markdown.indexOf(END_MARKER, begin);
+    if (end < 0) {
+        end = markdown.size();
+    }
+
+    const QStringView section = QStringView(markdown).mid(begin, end - begin);
+    QStringView stamp         = section.sliced(qstrlen(BEGIN_MARKER));
+    stamp                     = stamp.first(stamp.indexOf(u'\n') < 0 ? stamp.size() : stamp.indexOf(u'\n'));
+    if (stamp.endsWith(u"-->")) {
+        stamp.chop(3);
+    }
+    Snapshot snapshot;
+    snapshot.time = QDateTime::fromString(stamp.trimmed().toString(), Qt::ISODate);
+
+    // The first table lists the plugins, the second the mods
+    int table = -1;
+    for (const QStringView line : section.tokenize(u'\n')) {
+        if (!line.trimmed().startsWith(u'|')) {
+            continue;
+        }
+        const QStringList cells = splitRow(line);
+        if (cells.size() < 3) {
+            continue;
+        }
+        if (cells[0] == u"#") {
+            ++table;
+            continue;
+        }
+        bool isNumber = false;
+        cells[0].toInt(&isNumber);
+        if (!isNumber || table < 0 || table > 1) {
+            continue; // the alignment row
+        }
+        (table == 0 ? snapshot.plugins : snapshot.mods).append({ cells[1], !cells[2].isEmpty() });
+    }
+    return snapshot;
+}
+
+LoadOrder::Diff LoadOrder::diff(const QList<Entry>& before, const QList<Entry>& after)
+{
+    QHash<QString, int> oldPositions;
+    oldPositions.reserve(before.size());
+    for (int i = 0; i < before.size(); ++i) {
+        oldPositions.insert(before[i].name.toLower(), i);
+    }
+
+    Diff diff;
+    QList<int> common;      // old positions of the entries still there, in their new order
+    QList<int> newOfCommon; // their new positions
+    QList<bool> present(before.size(), false);
+    for (int i = 0; i < after.size(); ++i) {
+        const auto it = oldPositions.constFind(after[i].name.toLower());
+        if (it == oldPositions.cend() || present[*it]) {
+            diff.added.append(after[i].name);
+            continue;
+        }
+        present[*it] = true;
+        common.append(*it);
+        newOfCommon.append(i);
+        if (before[*it].enabled != after[i].enabled) {
+            (after[i].enabled ? diff.enabled : diff.disabled).append(after[i].name);
+        }
+    }
+    for (int i = 0; i < before.size(); ++i) {
+        if (!present[i]) {
+            diff.removed.append(before[i].name);
+        }
+    }
+
+    // Whatever is not part of the longest run that kept its order has moved
+    const QList<bool> kept = longestIncreasing(common);
+    for (qsizetype i = 0; i < common.size(); ++i) {
+        if (!kept[i]) {
+            diff.moved.append({ after[newOfCommon[i]].name, common[i] + 1, newOfCommon[i] + 1 });
+        }
+    }
+    return diff;
+}
+
+QString LoadOrder::diffToMarkdown(const Snapshot& before, const Snapshot& after)
+{
+    QString markdown = QString("### Load Order Changes since %1\n\n")
+                           .arg(QLocale().toString(before.time, QLocale::ShortFormat));
+    appendDiff(markdown, "Plugins", diff(before.plugins, after.plugins));
+    appendDiff(markdown, "Mods", diff(before.mods, after.mods));
+    return markdown;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <optional>
+
+// Load order snapshots written into the notes as markdown tables, and diffs between them; meant for a worker
+namespace LoadOrder {
+
+struct Entry {
+    QString name;
+    bool enabled = false;
+};
+
+struct Snapshot {
+    QDateTime time;
+    QList<Entry> plugins; // in load order
+    QList<Entry> mods;    // by priority, lowest first
+};
+
+struct Move {
+    QString name;
+    int from = 0; // 1-based positions
+    int to   = 0;
+};
+
+struct Diff {
+    QStringList added;
+    QStringList removed;
+    QStringList enabled;
+    QStringList disabled;
+    QList<Move> moved;
+
+    [[nodiscard]] bool isEmpty() const
+    {
+        return added.isEmpty() && removed.isEmpty() && enabled.isEmpty() && disabled.isEmpty() && moved.isEmpty();
+    }
+};
+
+QString toMarkdown(const Snapshot& snapshot);
+
+// The last snapshot written by toMarkdown() into the markdown
+std::optional<Snapshot> findLast(const QString& markdown);
+
+// Entries are matched by name, case-insensitively. The moved ones are those outside a longest run of entries that
+// kept their relative order, found in O(n log n).
+Diff diff(const QList<Entry>& before, const QList<Entry>& after);
+
+// Report of the changes from a snapshot to the current load order
+QString diffToMarkdown(const Snapshot& before, const Snapshot& after);
+
+}
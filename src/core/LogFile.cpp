@@ -0,0 +1,198 @@
+#include "LogFile.h"
+
+#include <QDir>
+#include <QFile>
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+namespace {
+char foldCase(const char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+
+struct FoldedHash {
+    std::size_t operator()(const char c) const { return std::hash<char>()(foldCase(c)); }
+};
+
+struct FoldedEqual {
+    bool operator()(const char a, const char b) const { return foldCase(a) == foldCase(b); }
+};
+
+// Maps size bytes of an open file from offset on; the mapping goes away when the file is closed
+const char* mapFile(QFile& file, const qint64 offset, const qint64 size)
+{
+    return reinterpret_cast<const char*>(file.map(offset, size));
+}
+}
+
+LogFile::LogFile(QString path)
+    : m_path(std::move(path))
+{
+    reset();
+}
+
+int LogFile::lineCount() const
+{
+    return static_cast<int>(m_lineStarts.size()) - (m_lineStarts.last() == m_size ? 1 : 0);
+}
+
+void LogFile::reset()
+{
+    m_lineStarts = { 0 };
+    m_size       = 0;
+    m_head.clear();
+}
+
+LogFile::Change LogFile::refresh()
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        const bool existed = std::exchange(m_exists, false);
+        reset();
+        return existed ? Change::Replaced : Change::None;
+    }
+
+    const qint64 size = file.size();
+    bool replaced     = !m_exists || size < m_size;
+    if (size == m_size && !replaced) {
+        return Change::None;
+    }
+    if (size == 0) {
+        reset();
+        m_exists = true;
+        return Change::Replaced;
+    }
+
+    const char* const data = mapFile(file, 0, size);
+    if (data == nullptr) {
+        return Change::None;
+    }
+    if (!replaced && QByteArrayView(data, m_head.size()) != m_head) {
+        replaced = true;
+    }
+    if (replaced) {
+        reset();
+    }
+    m_exists = true;
+
+    const char* const end = data + size;
+    for (const char* p = data + m_size; (p = static_cast<const char*>(std::memchr(p, '\n', end - p))) != nullptr;) {
+        ++p;
+        m_lineStarts.append(p - data);
+    }
+    if (m_head.size() < HEAD_LENGTH) {
+        m_head = QByteArray(data, std::min(size, static_cast<qint64>(HEAD_LENGTH)));
+    }
+    m_size = size;
+    return replaced ? Change::Replaced : Change::Appended;
+}
+
+qint64 LogFile::lineEnd(const int line) const
+{
+    if (line + 1 < m_lineStarts.size()) {
+        return m_lineStarts[line + 1] - 1; // the newline
+    }
+    return m_size;
+}
+
+int LogFile::lineAt(const qint64 offset) const
+{
+    const auto it = std::upper_bound(m_lineStarts.cbegin(), m_lineStarts.cend(), offset);
+    return static_cast<int>(it - m_lineStarts.cbegin()) - 1;
+}
+
+QStringList LogFile::lines(int first, const int count) const
+{
+    first          = std::max(first, 0);
+    const int last = std::min(first + count, lineCount());
+    if (first >= last) {
+        return {};
+    }
+
+    // A file that shrank was replaced; the next refresh() indexes it again
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < m_size) {
+        return {};
+    }
+    const qint64 begin     = m_lineStarts[first];
+    const qint64 length    = lineEnd(last - 1) - begin;
+    const char* const data = length > 0 ? mapFile(file, begin, length) : nullptr;
+    if (length > 0 && data == nullptr) {
+        return {};
+    }
+
+    QStringList result;
+    result.reserve(last - first);
+    for (int line = first; line < last; ++line) {
+        qint64 start = m_lineStarts[line] - begin;
+        qint64 end   = lineEnd(line) - begin;
+        if (end > start && data[end - 1] == '\r') {
+            --end;
+        }
+        result.append(QString::fromUtf8(data + start, std::min(end - start, static_cast<qint64>(MAX_LINE_LENGTH))));
+    }
+    return result;
+}
+
+int LogFile::find(const QString& text, const int from, const bool backward) const
+{
+    const QByteArray needle = text.toUtf8();
+    if (needle.isEmpty() || m_size == 0) {
+        return -1;
+    }
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < m_size) {
+        return -1;
+    }
+    const char* const data = mapFile(file, 0, m_size);
+    if (data == nullptr) {
+        return -1;
+    }
+
+    if (backward) {
+        // Matches end before the start of line from, so they lie in the lines before it
+        const qint64 end = from >= lineCount() ? m_size : m_lineStarts[std::max(from, 0)];
+        const std::reverse_iterator<const char*> rbegin(data + end);
+        const std::reverse_iterator<const char*> rend(data);
+        const std::boyer_moore_horspool_searcher searcher(
+            needle.crbegin(), needle.crend(), FoldedHash(), FoldedEqual());
+        const auto match = std::search(rbegin, rend, searcher);
+        return match == rend ? -1 : lineAt(match.base() - data - needle.size());
+    }
+
+    const int next = std::max(from + 1, 0);
+    if (next >= lineCount()) {
+        return -1;
+    }
+    const char* const begin = data + m_lineStarts[next];
+    const std::boyer_moore_horspool_searcher searcher(needle.cbegin(), needle.cend(), FoldedHash(), FoldedEqual());
+    const char* const match = std::search(begin, data + m_size, searcher);
+    return match == data + m_size ? -1 : lineAt(match - data);
+}
+
+QString LogFile::resolvePath(const QString& path, const QString& baseDirectory)
+{
+    static const QRegularExpression variableRe(R"(%([^%\s]+)%)");
+
+    QString resolved = path.trimmed();
+    for (qsizetype offset = 0;;) {
+        const QRegularExpressionMatch match = variableRe.match(resolved, offset);
+        if (!match.hasMatch()) {
+            break;
+        }
+        const QString value = qEnvironmentVariable(match.captured(1).toLocal8Bit().constData());
+        if (value.isEmpty()) {
+            offset = match.capturedEnd(); // left as it is, like the shell does
+            continue;
+        }
+        resolved.replace(match.capturedStart(), match.capturedLength(), value);
+        offset = match.capturedStart() + value.size();
+    }
+    if (resolved == "~" || resolved.startsWith("~/") || resolved.startsWith("~\\")) {
+        resolved.replace(0, 1, QDir::homePath());
+    }
+    return QDir::cleanPath(QDir(baseDirectory).absoluteFilePath(resolved));
+}
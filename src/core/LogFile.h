@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// A log file indexed by line and memory-mapped per call, so it is never held in memory; not thread-safe
+class LogFile {
+public:
+    enum class Change {
+        None,
+        Appended,
+        Replaced, // also when the file appeared or disappeared
+    };
+
+    static constexpr int MAX_LINE_LENGTH = 4096; // longer lines are cut in lines(), but found in full by find()
+
+    explicit LogFile(QString path);
+
+    [[nodiscard]] const QString& path() const { return m_path; }
+
+    [[nodiscard]] bool exists() const { return m_exists; }
+
+    [[nodiscard]] int lineCount() const;
+
+    // Indexes the lines appended since the last call
+    Change refresh();
+
+    // Up to count lines from first on, without line endings
+    [[nodiscard]] QStringList lines(int first, int count) const;
+
+    // The first line after from (the last before it, if backward) containing text, ignoring ASCII case;
+    // -1 if there is none. from may be -1 or lineCount() to search the whole file.
+    [[nodiscard]] int find(const QString& text, int from, bool backward) const;
+
+    // Expands %VARIABLE% references and a leading ~, and resolves a relative path against baseDirectory
+    [[nodiscard]] static QString resolvePath(const QString& path, const QString& baseDirectory);
+
+private:
+    void reset();
+    [[nodiscard]] int lineAt(qint64 offset) const;
+    [[nodiscard]] qint64 lineEnd(int line) const;
+
+    static constexpr qsizetype HEAD_LENGTH = 256;
+
+    QString m_path;
+    QList<qint64> m_lineStarts; // offset of every line start, and of the end if the file ends with a newline
+    qint64 m_size = 0;          // bytes indexed
+    QByteArray m_head;          // first bytes of the file, to tell that it was replaced
+    bool m_exists = false;
+};
@@ -0,0 +1,211 @@
+#include "ModMentionIndex.h"
+
+#include <QQueue>
+
+namespace {
+// Folds one UTF-16 unit, so names and text keep their lengths
+char16_t fold(const QChar c) { return c.toCaseFolded().unicode(); }
+
+QString foldName(const QString& name)
+{
+    QString folded(name.size(), Qt::Uninitialized);
+    for (qsizetype i = 0; i < name.size(); ++i) {
+        folded[i] = QChar(fold(name[i]));
+    }
+    return folded;
+}
+
+bool isWordCharacter(const QChar c) { return c.isLetterOrNumber() || c == u'_'; }
+
+quint64 edge(const int node, const char16_t c) { return static_cast<quint64>(node) << 16 | c; }
+}
+
+bool ModMentionIndex::isWholeWord(const QStringView text, const qsizetype from, const qsizetype length)
+{
+    const qsizetype to = from + length;
+    return !(from > 0 && isWordCharacter(text[from]) && isWordCharacter(text[from - 1]))
+        && !(to < text.size() && isWordCharacter(text[to - 1]) && isWordCharacter(text[to]));
+}
+
+void ModMentionIndex::setModNames(const QStringList& names, const QTextDocument* document)
+{
+    m_names = names;
+    build();
+
+    m_mentions.fill(0, m_names.size());
+    m_sections.fill(0, m_names.size());
+    if (!document) {
+        m_blocks.clear();
+        return;
+    }
+    m_blocks.reset(document, [this](const QTextBlock& block) { return scanBlock(block); });
+    BlockIndex<Mentions>::Change change;
+    change.added = m_blocks.entries();
+    apply(change);
+}
+
+void ModMentionIndex::build()
+{
+    m_ids.clear();
+    m_goto.clear();
+    m_nodes = { Node {} };
+
+    // Trie of the folded names, remembering each node's children for the breadth-first pass below
+    QList<QList<std::pair<char16_t, int>>> children(1);
+    for (int id = 0; id < m_names.size(); ++id) {
+        const QString folded = foldName(m_names[id]);
+        if (m_ids.contains(folded)) {
+            continue;
+        }
+        m_ids.insert(folded, id);
+        if (folded.size() < MIN_NAME_LENGTH) {
+            continue;
+        }
+
+        int node = 0;
+        for (const QChar c : folded) {
+            const auto it = m_goto.constFind(edge(node, c.unicode()));
+            if (it != m_goto.cend()) {
+                node = *it;
+                continue;
+            }
+            m_nodes.append(Node {});
+            children.append({});
+            const int child = static_cast<int>(m_nodes.size() - 1);
+            m_goto.insert(edge(node, c.unicode()), child);
+            children[node].append({ c.unicode(), child });
+            node = child;
+        }
+        m_nodes[node].output = id;
+    }
+
+    // Failure links point to the longest proper suffix that is also in the trie
+    QQueue<int> queue;
+    for (const auto& [c, child] : children[0]) {
+        queue.enqueue(child);
+    }
+    while (!queue.isEmpty()) {
+        const int node = queue.dequeue();
+        for (const auto& [c, child] : children[node]) {
+            int fail = m_nodes[node].fail;
+            while (fail != 0 && !m_goto.contains(edge(fail, c))) {
+                fail = m_nodes[fail].fail;
+            }
+            m_nodes[child].fail = m_goto.value(edge(fail, c), 0);
+            const Node& suffix  = m_nodes[m_nodes[child].fail];
+            m_nodes[child].next = suffix.output >= 0 ? m_nodes[child].fail : suffix.next;
+            queue.enqueue(child);
+        }
+    }
+}
+
+int ModMentionIndex::step(int node, const char16_t c) const
+{
+    while (true) {
+        if (const auto it = m_goto.constFind(edge(node, c)); it != m_goto.cend()) {
+            return *it;
+        }
+        if (node == 0) {
+            return 0;
+        }
+        node = m_nodes[node].fail;
+    }
+}
+
+QList<ModMentionIndex::Mention> ModMentionIndex::mentionsIn(const QStringView text) const
+{
+    QList<Mention> found;
+    if (text.size() < MIN_NAME_LENGTH || m_nodes.size() == 1) {
+        return found;
+    }
+
+    int node = 0;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        node = step(node, fold(text[i]));
+        for (int n = m_nodes[node].output >= 0 ? node : m_nodes[node].next; n != 0; n = m_nodes[n].next) {
+            const int id           = m_nodes[n].output;
+            const qsizetype length = m_names[id].size();
+            if (isWholeWord(text, i + 1 - length, length)) {
+                found.append({ id, i + 1 - length, length });
+            }
+        }
+    }
+    return found;
+}
+
+std::optional<ModMentionIndex::Mentions> ModMentionIndex::scanBlock(const QTextBlock& block) const
+{
+    const QString text = block.text();
+    Mentions mentions;
+    for (const Mention& mention : mentionsIn(text)) {
+        if (!mentions.mods.contains(mention.id)) {
+            mentions.mods.append(mention.id);
+        }
+    }
+    if (mentions.mods.isEmpty()) {
+        return std::nullopt;
+    }
+    mentions.heading = QStringView(text).trimmed().startsWith(u'#');
+    return mentions;
+}
+
+bool ModMentionIndex::apply(const BlockIndex<Mentions>::Change& change)
+{
+    bool changed = false;
+    for (const auto& entry : change.removed) {
+        for (const int id : entry.value.mods) {
+            changed |= --m_mentions[id] == 0;
+            if (entry.value.heading) {
+                changed |= --m_sections[id] == 0;
+            }
+        }
+    }
+    for (const auto& entry : change.added) {
+        for (const int id : entry.value.mods) {
+            changed |= m_mentions[id]++ == 0;
+            if (entry.value.heading) {
+                changed |= m_sections[id]++ == 0;
+            }
+        }
+    }
+    return changed;
+}
+
+bool ModMentionIndex::update(const QTextDocument* document, const int position, const int charsAdded)
+{
+    if (m_names.isEmpty()) {
+        return false;
+    }
+    return apply(m_blocks.update(
+        document, position, charsAdded, [this](const QTextBlock& block) { return scanBlock(block); }));
+}
+
+ModMentionIndex::Presence ModMentionIndex::presence(const QString& name) const
+{
+    const int id = m_ids.value(foldName(name), -1);
+    if (id < 0 || m_mentions[id] == 0) {
+        return Presence::None;
+    }
+    return m_sections[id] > 0 ? Presence::Section : Presence::Mentioned;
+}
+
+int ModMentionIndex::mentionCount(const QString& name) const
+{
+    const int id = m_ids.value(foldName(name), -1);
+    return id < 0 ? 0 : m_mentions[id];
+}
+
+QList<int> ModMentionIndex::blocksMentioning(const QString& name) const
+{
+    QList<int> blocks;
+    const int id = m_ids.value(foldName(name), -1);
+    if (id < 0 || m_mentions[id] == 0) {
+        return blocks;
+    }
+    for (const auto& entry : m_blocks.entries()) {
+        if (entry.value.mods.contains(id)) {
+            blocks.append(entry.block);
+        }
+    }
+    return blocks;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "BlockIndex.h"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// Which mods or plugins the notes mention as whole words, kept up to date from document changes
+class ModMentionIndex {
+public:
+    enum class Presence {
+        None,
+        Mentioned, // the name appears in the text
+        Section,   // the name appears in a heading
+    };
+
+    struct Mention {
+        int id; // index into the names
+        qsizetype from;
+        qsizetype length;
+    };
+
+    static constexpr qsizetype MIN_NAME_LENGTH = 3; // shorter names would match all over the place
+
+    // Whether text[from, from + length) is a mention: whole words only, where the name starts or ends with a
+    // word character
+    [[nodiscard]] static bool isWholeWord(QStringView text, qsizetype from, qsizetype length);
+
+    // Replaces the mod names and re-scans the document; without one, only mentionsIn() is of use
+    void setModNames(const QStringList& names, const QTextDocument* document);
+
+    // Every whole-word mention in text, in the order they end
+    [[nodiscard]] QList<Mention> mentionsIn(QStringView text) const;
+
+    // Call with the arguments of QTextDocument::contentsChange; returns whether the presence of any mod changed
+    bool update(const QTextDocument* document, int position, int charsAdded);
+
+    [[nodiscard]] Presence presence(const QString& name) const;
+
+    // Number of blocks mentioning the mod
+    [[nodiscard]] int mentionCount(const QString& name) const;
+
+    // Numbers of the blocks mentioning the mod, ascending
+    [[nodiscard]] QList<int> blocksMentioning(const QString& name) const;
+
+private:
+    struct Mentions {
+        QList<int> mods; // distinct, by id
+        bool heading = false;
+    };
+
+    struct Node {
+        int fail   = 0;
+        int output = -1; // mod id of the name ending here, or -1
+        int next   = 0;  // nearest node on the fail chain with an output, 0 if none
+    };
+
+    void build();
+    [[nodiscard]] int step(int node, char16_t c) const;
+    [[nodiscard]] std::optional<Mentions> scanBlock(const QTextBlock& block) const;
+    bool apply(const BlockIndex<Mentions>::Change& change);
+
+    QStringList m_names;        // by id
+    QHash<QString, int> m_ids;  // case-folded name -> id
+    QList<Node> m_nodes;        // trie node 0 is the root
+    QHash<quint64, int> m_goto; // (node << 16 | character) -> child node
+    QList<int> m_mentions;      // by id, number of blocks mentioning the mod
+    QList<int> m_sections;      // by id, number of headings mentioning the mod
+    BlockIndex<Mentions> m_blocks;
+};
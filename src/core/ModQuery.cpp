@@ -0,0 +1,121 @@
+#include "ModQuery.h"
+
+#include <QRegularExpression>
+
+namespace ModQuery {
+
+namespace {
+const QString CHECK = QStringLiteral("✓");
+
+bool accepts(const Query::Filter filter, const bool value)
+{
+    return filter == Query::Filter::Any || (filter == Query::Filter::Yes) == value;
+}
+
+void addRow(Table& table, QStringList row)
+{
+    if (table.total++ < MAX_ROWS) {
+        table.rows.append(std::move(row));
+    }
+}
+}
+
+int Query::inputs() const
+{
+    if (subject == Subject::Plugins) {
+        return PluginList;
+    }
+    return ModList | (notes != Filter::Any ? Notes : 0);
+}
+
+std::optional<Query> parse(const QString& text, QString* error)
+{
+    static const QRegularExpression subjectRe(
+        R"(^(?:(enabled|active|disabled|inactive)\s+)?(mods|plugins)\b)", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression clauseRe(
+        R"(\s+(?:in\s+separator\s+(?:"(?<separatorQuoted>[^"]*)"|(?<separator>.+?))|(?<notes>with|without)\s+notes)"
+        R"(|matching\s+(?:"(?<matchingQuoted>[^"]*)"|(?<matching>.+?)))"
+        R"((?=\s+(?:in\s+separator|with\s+notes|without\s+notes|matching)\b|$))",
+        QRegularExpression::CaseInsensitiveOption);
+
+    const QString query                   = text.simplified();
+    const QRegularExpressionMatch subject = subjectRe.match(query);
+    if (!subject.hasMatch()) {
+        *error = "A query starts with \"mods\" or \"plugins\", optionally after \"enabled\" or \"disabled\".";
+        return std::nullopt;
+    }
+
+    Query result;
+    result.subject = subject.captured(2).compare("plugins", Qt::CaseInsensitive) == 0 ? Query::Subject::Plugins
+                                                                                      : Query::Subject::Mods;
+    if (subject.hasCaptured(1)) {
+        const QString state = subject.captured(1).toLower();
+        result.enabled      = state == "enabled" || state == "active" ? Query::Filter::Yes : Query::Filter::No;
+    }
+
+    for (qsizetype offset = subject.capturedEnd(); offset < query.size();) {
+        const QRegularExpressionMatch clause = clauseRe.match(
+            query, offset, QRegularExpression::NormalMatch, QRegularExpression::AnchorAtOffsetMatchOption);
+        if (!clause.hasMatch()) {
+            *error = QString("Cannot read \"%1\".").arg(query.mid(offset).trimmed());
+            return std::nullopt;
+        }
+        if (clause.hasCaptured("separatorQuoted") || clause.hasCaptured("separator")) {
+            result.separator = clause.hasCaptured("separatorQuoted") ? clause.captured("separatorQuoted")
+                                                                     : clause.captured("separator");
+        } else if (clause.hasCaptured("notes")) {
+            result.notes = clause.captured("notes").compare("with", Qt::CaseInsensitive) == 0 ? Query::Filter::Yes
+                                                                                               : Query::Filter::No;
+        } else {
+            result.matching = clause.hasCaptured("matchingQuoted") ? clause.captured("matchingQuoted")
+                                                                   : clause.captured("matching");
+        }
+        offset = clause.capturedEnd();
+    }
+
+    if (result.subject == Query::Subject::Plugins && (result.separator || result.notes != Query::Filter::Any)) {
+        *error = "Separators and notes only apply to mods.";
+        return std::nullopt;
+    }
+    return result;
+}
+
+Table evaluate(const Query& query, const QList<Mod>& mods, const QList<Plugin>& plugins,
+    const std::function<bool(const QString& mod)>& mentioned)
+{
+    Table table;
+    if (query.subject == Query::Subject::Plugins) {
+        table.columns = { "#", "Plugin", "Enabled", "Mod" };
+        for (qsizetype i = 0; i < plugins.size(); ++i) {
+            const Plugin& plugin = plugins[i];
+            if (accepts(query.enabled, plugin.enabled)
+                && (query.matching.isEmpty() || plugin.name.contains(query.matching, Qt::CaseInsensitive))) {
+                const QString enabled = plugin.enabled ? CHECK : QString();
+                addRow(table, { QString::number(i + 1), plugin.name, enabled, plugin.origin });
+            }
+        }
+        return table;
+    }
+
+    table.columns = { "#", "Mod", "Enabled" };
+    if (!query.separator) {
+        table.columns.append("Separator");
+    }
+    for (qsizetype i = 0; i < mods.size(); ++i) {
+        const Mod& mod = mods[i];
+        if (!accepts(query.enabled, mod.enabled)
+            || (query.separator && mod.separator.compare(*query.separator, Qt::CaseInsensitive) != 0)
+            || (!query.matching.isEmpty() && !mod.name.contains(query.matching, Qt::CaseInsensitive))
+            || (query.notes != Query::Filter::Any && !accepts(query.notes, mentioned(mod.name)))) {
+            continue;
+        }
+        QStringList row = { QString::number(i + 1), mod.name, mod.enabled ? CHECK : QString() };
+        if (!query.separator) {
+            row.append(mod.separator);
+        }
+        addRow(table, std::move(row));
+    }
+    return table;
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+#include <optional>
+
+// Queries of ```mo2query blocks over the mod and plugin lists, in the form
+// [enabled|disabled] (mods|plugins) [in separator NAME] [with notes|without notes] [matching TEXT]
+namespace ModQuery {
+
+enum Input {
+    ModList    = 1 << 0,
+    PluginList = 1 << 1,
+    Notes      = 1 << 2, // which mods the notes mention
+};
+
+struct Mod {
+    QString name;
+    QString separator; // the separator the mod is listed under, without its "_separator" suffix
+    bool enabled = false;
+};
+
+struct Plugin {
+    QString name;
+    QString origin; // mod providing the plugin
+    bool enabled = false;
+};
+
+struct Query {
+    enum class Subject {
+        Mods,
+        Plugins,
+    };
+    enum class Filter {
+        Any,
+        Yes,
+        No,
+    };
+
+    Subject subject = Subject::Mods;
+    Filter enabled  = Filter::Any;
+    Filter notes    = Filter::Any; // mentioned in the notes
+    std::optional<QString> separator;
+    QString matching;
+
+    // ModQuery::Input flags of what evaluate() reads for this query
+    [[nodiscard]] int inputs() const;
+};
+
+struct Table {
+    QStringList columns;
+    QList<QStringList> rows;
+    qsizetype total = 0; // rows before MAX_ROWS was applied
+};
+
+constexpr qsizetype MAX_ROWS = 1000;
+
+// The query in text, or an error message
+std::optional<Query> parse(const QString& text, QString* error);
+
+// mods by priority, lowest first; plugins in load order. mentioned is only called for queries about notes.
+Table evaluate(const Query& query, const QList<Mod>& mods, const QList<Plugin>& plugins,
+    const std::function<bool(const QString& mod)>& mentioned);
+
+}
@@ -0,0 +1,129 @@
+#include "OutlineIndex.h"
+
+std::optional<OutlineIndex::Line> OutlineIndex::scan(const QTextBlock& block)
+{
+    const QString text = block.text();
+
+    // Up to three spaces of indentation are allowed before the marker
+    qsizetype start = 0;
+    while (start < text.size() && start < 4 && text[start] == ' ') {
+        ++start;
+    }
+    if (start > 3 || start >= text.size()) {
+        return std::nullopt;
+    }
+
+    const QChar marker = text[start];
+    qsizetype end      = start;
+    while (end < text.size() && text[end] == marker) {
+        ++end;
+    }
+    const auto count = static_cast<int>(end - start);
+
+    if ((marker == '`' || marker == '~') && count >= 3) {
+        Line line;
+        line.fenceChar    = marker;
+        line.fenceLength  = count;
+        line.fenceHasInfo = !text.mid(end).trimmed().isEmpty();
+        return line;
+    }
+
+    if (marker != '#' || count > 6 || (end < text.size() && text[end] != ' ' && text[end] != '\t')) {
+        return std::nullopt;
+    }
+
+    // Strip an optional closing sequence of #s
+    QString title     = text.mid(end).trimmed();
+    qsizetype closing = title.size();
+    while (closing > 0 && title[closing - 1] == '#') {
+        --closing;
+    }
+    if (closing == 0 || title[closing - 1] == ' ' || title[closing - 1] == '\t') {
+        title = title.left(closing).trimmed();
+    }
+
+    Line line;
+    line.level = count;
+    line.title = title;
+    return line;
+}
+
+void OutlineIndex::reset(const QTextDocument* document) { m_lines.reset(document, &OutlineIndex::scan); }
+
+bool OutlineIndex::update(const QTextDocument* document, const int position, const int charsAdded)
+{
+    const auto change = m_lines.update(document, position, charsAdded, &OutlineIndex::scan);
+    if (change.removed.size() != change.added.size()) {
+        return true;
+    }
+    // Shifted block numbers alone do not change what the outline shows
+    for (size_t i = 0; i < change.removed.size(); ++i) {
+        if (change.removed[i].value != change.added[i].value) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Visitor> void OutlineIndex::walk(Visitor visit) const
+{
+    QChar openFence;
+    int openLength = 0;
+    for (const auto& [block, line] : m_lines.entries()) {
+        if (line.level == 0) {
+            // A fence closes the open block if it uses the same character, is at least as long and has no info string
+            if (openLength == 0) {
+                openFence  = line.fenceChar;
+                openLength = line.fenceLength;
+                visit(block, line, false);
+            } else if (line.fenceChar == openFence && line.fenceLength >= openLength && !line.fenceHasInfo) {
+                openLength = 0;
+                visit(block, line, false);
+            }
+        } else {
+            visit(block, line, openLength != 0);
+        }
+    }
+}
+
+QList<OutlineIndex::Heading> OutlineIndex::headings() const
+{
+    QList<Heading> result;
+    walk([&result](const int block, const Line& line, const bool inFence) {
+        if (line.level > 0 && !inFence) {
+            result.append({ block, line.level, line.title });
+        }
+    });
+    return result;
+}
+
+QList<OutlineIndex::Fence> OutlineIndex::fences(const int blockCount) const
+{
+    QList<Fence> result;
+    bool open = false;
+    walk([&result, &open](const int block, const Line& line, bool) {
+        if (line.level != 0) {
+            return;
+        }
+        if (open) {
+            result.last().close = block;
+        } else {
+            result.append({ block, -1 });
+        }
+        open = !open;
+    });
+    if (open) {
+        result.last().close = blockCount - 1;
+    }
+    return result;
+}
+
+int OutlineIndex::sectionEnd(const QList<Heading>& headings, const qsizetype index, const int blockCount)
+{
+    for (qsizetype i = index + 1; i < headings.size(); ++i) {
+        if (headings[i].level <= headings[index].level) {
+            return headings[i].block;
+        }
+    }
+    return blockCount;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "BlockIndex.h"
+
+#include <QList>
+#include <QString>
+
+// Heading outline of the notes, maintained incrementally from document changes
+class OutlineIndex {
+public:
+    struct Heading {
+        int block; // block (= source line) number
+        int level; // 1..6
+        QString title;
+    };
+
+    void reset(const QTextDocument* document);
+
+    // Call with the arguments of QTextDocument::contentsChange; returns whether the headings may have changed
+    bool update(const QTextDocument* document, int position, int charsAdded);
+
+    void clear() { m_lines.clear(); }
+
+    struct Fence {
+        int open;  // block of the opening fence line
+        int close; // block of the closing fence line, or the last block if the fence is never closed
+    };
+
+    // Headings outside fenced code, in document order
+    [[nodiscard]] QList<Heading> headings() const;
+
+    // Fenced code blocks, in document order
+    [[nodiscard]] QList<Fence> fences(int blockCount) const;
+
+    // One past the last block of the section started by headings[index]
+    [[nodiscard]] static int sectionEnd(const QList<Heading>& headings, qsizetype index, int blockCount);
+
+private:
+    struct Line {
+        int level = 0;   // heading level, 0 for a fence line
+        QChar fenceChar; // '`' or '~' for a fence line
+        int fenceLength   = 0;
+        bool fenceHasInfo = false;
+        QString title;
+
+        bool operator==(const Line& other) const = default;
+    };
+
+    static std::optional<Line> scan(const QTextBlock& block);
+
+    // Calls visit(block, line, inFence) for every indexed line; fence lines count as outside
+    template <typename Visitor> void walk(Visitor visit) const;
+
+    BlockIndex<Line> m_lines;
+};
@@ -0,0 +1,44 @@
+#include "PreviewCache.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QSaveFile>
+
+namespace {
+// Bump when the preview renders the same markdown differently
+constexpr auto CACHE_VERSION = "1";
+
+QString hash(const QString& text)
+{
+    return QString::fromLatin1(QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+}
+
+QString PreviewCache::key(const QString& markdown, const QString& styleSheet)
+{
+    return QString("%1-%2-%3").arg(CACHE_VERSION, hash(markdown), hash(styleSheet));
+}
+
+QString PreviewCache::load(const QString& path, const QString& key)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    // Compare the key before reading the rest
+    if (file.readLine().trimmed() != key.toLatin1()) {
+        return {};
+    }
+    return QString::fromUtf8(file.readAll());
+}
+
+bool PreviewCache::store(const QString& path, const QString& key, const QString& html)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(key.toLatin1() + '\n');
+    file.write(html.toUtf8());
+    return file.commit();
+}
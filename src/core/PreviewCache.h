@@ -0,0 +1,15 @@
+#pragma once
+
+#include <QString>
+
+// Rendered preview HTML stored next to a profile's notes; safe to call from workers
+namespace PreviewCache {
+
+QString key(const QString& markdown, const QString& styleSheet);
+
+// Cached HTML if the file holds an entry for key, otherwise a null string
+QString load(const QString& path, const QString& key);
+
+bool store(const QString& path, const QString& key, const QString& html);
+
+}
@@ -0,0 +1,139 @@
+#include "ReferenceRewrite.h"
+#include "ModMentionIndex.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QStringTokenizer>
+
+#include <algorithm>
+
+namespace ReferenceRewrite {
+
+QList<Rename> renamed(const QHash<QString, QString>& before, const QHash<QString, QString>& after)
+{
+    if (before.size() != after.size()) {
+        return {};
+    }
+
+    QString from;
+    for (auto it = before.cbegin(); it != before.cend(); ++it) {
+        const auto kept = after.constFind(it.key());
+        if (kept == after.cend()) {
+            if (!from.isEmpty()) {
+                return {}; // more than one name went away
+            }
+            from = it.key();
+        } else if (*kept != *it) {
+            return {}; // the list was rearranged as well
+        }
+    }
+    if (from.isEmpty()) {
+        return {};
+    }
+
+    // With the sizes equal, exactly one name came in
+    for (auto it = after.cbegin(); it != after.cend(); ++it) {
+        if (!before.contains(it.key())) {
+            return *it == before.value(from) ? QList<Rename> { { from, it.key() } } : QList<Rename> {};
+        }
+    }
+    return {};
+}
+
+QList<Reference> find(const QStringView line, const QList<Rename>& renames)
+{
+    QList<Reference> references;
+    for (qsizetype i = 0; i < renames.size(); ++i) {
+        const QString& name = renames[i].from;
+        if (name.size() < ModMentionIndex::MIN_NAME_LENGTH) {
+            continue;
+        }
+        qsizetype from = line.indexOf(name, 0, Qt::CaseInsensitive);
+        while (from >= 0) {
+            if (ModMentionIndex::isWholeWord(line, from, name.size())) {
+                references.append({ from, name.size(), i });
+            }
+            from = line.indexOf(name, from + 1, Qt::CaseInsensitive);
+        }
+    }
+    if (references.size() < 2) {
+        return references;
+    }
+
+    std::ranges::sort(references, [](const Reference& a, const Reference& b) {
+        return a.from != b.from ? a.from < b.from : a.length > b.length;
+    });
+    qsizetype end = 0;
+    references.removeIf([&end](const Reference& reference) {
+        if (reference.from < end) {
+            return true;
+        }
+        end = reference.from + reference.length;
+        return false;
+    });
+    return references;
+}
+
+qsizetype count(const QStringView text, const QList<Rename>& renames)
+{
+    qsizetype references = 0;
+    for (const QStringView line : QStringTokenizer(text, u'\n')) {
+        references += find(line, renames).size();
+    }
+    return references;
+}
+
+qsizetype rewriteLine(QString& line, const QList<Rename>& renames)
+{
+    const QList<Reference> references = find(line, renames);
+    for (auto it = references.crbegin(); it != references.crend(); ++it) {
+        line.replace(it->from, it->length, renames[it->rename].to);
+    }
+    return references.size();
+}
+
+qsizetype rewriteFile(const QString& path, const QList<Rename>& renames, QString* error)
+{
+    QFile in(path);
+    if (!in.open(QIODevice::ReadOnly)) {
+        *error = in.errorString();
+        return -1;
+    }
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        *error = out.errorString();
+        return -1;
+    }
+
+    qsizetype replaced = 0;
+    while (!in.atEnd()) {
+        const QByteArray raw = in.readLine();
+        qsizetype end        = raw.size();
+        while (end > 0 && (raw[end - 1] == '\n' || raw[end - 1] == '\r')) {
+            --end;
+        }
+
+        QString line          = QString::fromUtf8(raw.constData(), end);
+        const qsizetype count = rewriteLine(line, renames);
+        if (count == 0) {
+            out.write(raw);
+            continue;
+        }
+        replaced += count;
+        out.write(line.toUtf8());
+        out.write(raw.constData() + end, raw.size() - end);
+    }
+    in.close();
+
+    if (replaced == 0) {
+        out.cancelWriting();
+        return 0;
+    }
+    if (!out.commit()) {
+        *error = out.errorString();
+        return -1;
+    }
+    return replaced;
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+// Rewrites whole-word references to renamed mods and plugins, by the same rules as ModMentionIndex
+namespace ReferenceRewrite {
+
+struct Rename {
+    QString from;
+    QString to;
+};
+
+struct Reference {
+    qsizetype from;
+    qsizetype length;
+    qsizetype rename; // index into the renames
+};
+
+// The rename between two lists of names mapped to their anchors, if that is all that changed: one name went
+// away, one came in under the same anchor, and every other name kept its anchor. Anything more is as likely an
+// uninstall and an install as a rename, and gives no rename at all.
+[[nodiscard]] QList<Rename> renamed(const QHash<QString, QString>& before, const QHash<QString, QString>& after);
+
+// References in line, ascending and not overlapping; where names overlap, the longer one wins
+[[nodiscard]] QList<Reference> find(QStringView line, const QList<Rename>& renames);
+
+// Number of references in text, found line by line as rewriteLine would
+[[nodiscard]] qsizetype count(QStringView text, const QList<Rename>& renames);
+
+// Returns the number of references replaced
+qsizetype rewriteLine(QString& line, const QList<Rename>& renames);
+
+// Streams the file through rewriteLine, keeping its line endings; the file is left untouched when nothing was
+// replaced. Returns the number of references replaced, or -1 with error set.
+qsizetype rewriteFile(const QString& path, const QList<Rename>& renames, QString* error);
+
+}
@@ -0,0 +1,56 @@
+#include "SourceMap.h"
+
+#include <algorithm>
+
+void SourceMap::reset(const QVariantList& flatLayout)
+{
+    m_anchors.clear();
+    m_anchors.reserve(flatLayout.size() / 4);
+
+    for (qsizetype i = 0; i + 3 < flatLayout.size(); i += 4) {
+        Anchor anchor { flatLayout[i].toInt(), flatLayout[i + 1].toInt(), flatLayout[i + 2].toDouble(),
+            flatLayout[i + 3].toDouble() };
+        anchor.endLine = std::max(anchor.endLine, anchor.startLine + 1);
+
+        // Blocks arrive in document order; drop anything that would break the ordering
+        if (!m_anchors.empty() && anchor.startLine < m_anchors.back().startLine) {
+            continue;
+        }
+        m_anchors.push_back(anchor);
+    }
+}
+
+SourceMap::Position SourceMap::positionForLine(const double line) const
+{
+    if (m_anchors.empty()) {
+        return {};
+    }
+
+    // Last block starting at or before the line
+    auto it = std::upper_bound(m_anchors.begin(), m_anchors.end(), line,
+        [](const double value, const Anchor& anchor) { return value < anchor.startLine; });
+    if (it != m_anchors.begin()) {
+        --it;
+    }
+
+    const double span     = it->endLine - it->startLine;
+    const double fraction = std::clamp((line - it->startLine) / span, 0.0, 1.0);
+    return { static_cast<int>(it - m_anchors.begin()), fraction };
+}
+
+double SourceMap::lineForOffset(const double offset) const
+{
+    if (m_anchors.empty()) {
+        return 0.0;
+    }
+
+    // Last block whose top is at or above the offset
+    auto it = std::upper_bound(m_anchors.begin(), m_anchors.end(), offset,
+        [](const double value, const Anchor& anchor) { return value < anchor.top; });
+    if (it != m_anchors.begin()) {
+        --it;
+    }
+
+    const double fraction = it->height > 0 ? std::clamp((offset - it->top) / it->height, 0.0, 1.0) : 0.0;
+    return it->startLine + fraction * (it->endLine - it->startLine);
+}
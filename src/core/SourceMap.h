@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QVariantList>
+
+#include <vector>
+
+// Maps editor source lines to rendered preview blocks and back
+class SourceMap {
+public:
+    struct Anchor {
+        int startLine; // first source line of the block
+        int endLine;   // one past the last source line of the block
+        double top;    // offset of the block in the preview, in CSS pixels
+        double height;
+    };
+
+    struct Position {
+        int anchor      = -1;  // index of the preview block
+        double fraction = 0.0; // position inside the block, 0..1
+    };
+
+    // Replaces the map from a flat [start, end, top, height, ...] list as sent by the preview
+    void reset(const QVariantList& flatLayout);
+
+    void clear() { m_anchors.clear(); }
+
+    [[nodiscard]] bool isEmpty() const { return m_anchors.empty(); }
+
+    // Preview block and offset inside it for a (fractional) source line
+    [[nodiscard]] Position positionForLine(double line) const;
+
+    // Fractional source line shown at a preview scroll offset
+    [[nodiscard]] double lineForOffset(double offset) const;
+
+private:
+    std::vector<Anchor> m_anchors;
+};
@@ -0,0 +1,55 @@
+#include "TaskIndex.h"
+
+#include <QRegularExpression>
+
+std::optional<TaskIndex::Item> TaskIndex::parse(const QStringView line)
+{
+    // A bullet or ordered list marker followed by [ ], [x] or [X]
+    static const QRegularExpression pattern(R"(^\s*(?:[-*+]|\d{1,9}[.)])\s+\[([ xX])\](?:\s+(.*))?$)");
+
+    // Cheap rejection first; most lines are not tasks
+    if (!line.contains(u'[')) {
+        return std::nullopt;
+    }
+    const QRegularExpressionMatch match = pattern.matchView(line);
+    if (!match.hasMatch()) {
+        return std::nullopt;
+    }
+    return Item { match.capturedView(1) != u" ", match.captured(2).trimmed() };
+}
+
+std::optional<TaskIndex::Item> TaskIndex::scanBlock(const QTextBlock& block) { return parse(block.text()); }
+
+void TaskIndex::reset(const QTextDocument* document)
+{
+    m_items.reset(document, &TaskIndex::scanBlock);
+    m_open = 0;
+    m_done = 0;
+    for (const auto& entry : m_items.entries()) {
+        ++(entry.value.done ? m_done : m_open);
+    }
+}
+
+void TaskIndex::update(const QTextDocument* document, const int position, const int charsAdded)
+{
+    const auto change = m_items.update(document, position, charsAdded, &TaskIndex::scanBlock);
+    for (const auto& entry : change.removed) {
+        --(entry.value.done ? m_done : m_open);
+    }
+    for (const auto& entry : change.added) {
+        ++(entry.value.done ? m_done : m_open);
+    }
+}
+
+QList<TaskIndex::Task> TaskIndex::scan(const QString& markdown)
+{
+    QList<Task> tasks;
+    int line = 0;
+    for (const QStringView text : QStringView(markdown).tokenize(u'\n')) {
+        if (const std::optional<Item> item = parse(text)) {
+            tasks.append({ line, item->done, item->text });
+        }
+        ++line;
+    }
+    return tasks;
+}
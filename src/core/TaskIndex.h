@@ -0,0 +1,40 @@
+#pragma once
+
+#include "BlockIndex.h"
+
+#include <QList>
+#include <QString>
+
+// Checkbox list items of the notes, maintained incrementally from document changes
+class TaskIndex {
+public:
+    struct Task {
+        int line  = 0; // 0-based source line
+        bool done = false;
+        QString text;
+    };
+
+    void reset(const QTextDocument* document);
+
+    // Call with the arguments of QTextDocument::contentsChange
+    void update(const QTextDocument* document, int position, int charsAdded);
+
+    [[nodiscard]] int openCount() const { return m_open; }
+    [[nodiscard]] int doneCount() const { return m_done; }
+
+    // Tasks of a document that is not open in the editor
+    static QList<Task> scan(const QString& markdown);
+
+private:
+    struct Item {
+        bool done = false;
+        QString text;
+    };
+
+    static std::optional<Item> parse(QStringView line);
+    static std::optional<Item> scanBlock(const QTextBlock& block);
+
+    BlockIndex<Item> m_items;
+    int m_open = 0;
+    int m_done = 0;
+};
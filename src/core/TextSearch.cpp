@@ -0,0 +1,112 @@
+#include "TextSearch.h"
+
+#include <QElapsedTimer>
+
+namespace {
+constexpr qsizetype BATCH_SIZE  = 1000; // matches per batch
+constexpr qint64 BATCH_INTERVAL = 50;   // ms; sparse matches are still reported this often
+}
+
+QRegularExpression TextSearch::expression(const Options& options)
+{
+    QString pattern = options.regex ? options.pattern : QRegularExpression::escape(options.pattern);
+    if (options.wholeWords) {
+        pattern = QString("\\b(?:%1)\\b").arg(pattern);
+    }
+
+    QRegularExpression::PatternOptions patternOptions = QRegularExpression::MultilineOption;
+    if (!options.caseSensitive) {
+        patternOptions |= QRegularExpression::CaseInsensitiveOption;
+    }
+    QRegularExpression expression(pattern, patternOptions);
+    expression.optimize();
+    return expression;
+}
+
+void TextSearch::scan(const QString& text, const QRegularExpression& expression, const qsizetype maxMatches,
+    const std::function<bool(const QList<Match>& batch, bool last)>& onBatch)
+{
+    QList<Match> batch;
+    qsizetype found = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    QRegularExpressionMatchIterator it = expression.globalMatch(text);
+    while (it.hasNext() && found < maxMatches) {
+        const QRegularExpressionMatch match = it.next();
+        if (match.capturedLength() == 0) {
+            continue;
+        }
+        batch.append({ match.capturedStart(), match.capturedLength() });
+        ++found;
+
+        if (batch.size() >= BATCH_SIZE || timer.elapsed() >= BATCH_INTERVAL) {
+            if (!onBatch(batch, false)) {
+                return;
+            }
+            batch.clear();
+            timer.restart();
+        }
+    }
+    onBatch(batch, true);
+}
+
+QString TextSearch::expand(const QRegularExpressionMatch& match, const QString& replacement, const bool regex)
+{
+    if (!regex) {
+        return replacement;
+    }
+
+    QString result;
+    result.reserve(replacement.size());
+    for (qsizetype i = 0; i < replacement.size(); ++i) {
+        const QChar c = replacement[i];
+        if (c != '\\' || i + 1 == replacement.size()) {
+            result.append(c);
+            continue;
+        }
+        const QChar next = replacement[++i];
+        if (next.isDigit()) {
+            result.append(match.captured(next.digitValue()));
+        } else if (next == 'n') {
+            result.append('\n');
+        } else if (next == 't') {
+            result.append('\t');
+        } else {
+            result.append(next);
+        }
+    }
+    return result;
+}
+
+TextSearch::Replacement TextSearch::replaceAll(const QString& text, const QRegularExpression& expression,
+    const QString& replacement, const bool regex, const std::function<bool()>& shouldStop)
+{
+    Replacement result;
+    qsizetype last = -1; // end of the previous match
+
+    QRegularExpressionMatchIterator it = expression.globalMatch(text);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        if (match.capturedLength() == 0) {
+            continue;
+        }
+        if (result.count % BATCH_SIZE == 0 && shouldStop()) {
+            return {};
+        }
+
+        if (last < 0) {
+            result.position = match.capturedStart();
+        } else {
+            result.text.append(QStringView(text).mid(last, match.capturedStart() - last));
+        }
+        result.text.append(expand(match, replacement, regex));
+        last = match.capturedEnd();
+        ++result.count;
+    }
+
+    if (last >= 0) {
+        result.length = last - result.position;
+    }
+    return result;
+}
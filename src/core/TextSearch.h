@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+
+#include <functional>
+
+// Find and replace over a copy of the notes, meant to run on a worker
+namespace TextSearch {
+
+struct Options {
+    QString pattern;
+    bool regex         = false;
+    bool caseSensitive = false;
+    bool wholeWords    = false;
+};
+
+struct Match {
+    qsizetype position = 0;
+    qsizetype length   = 0;
+};
+
+struct Replacement {
+    qsizetype position = 0; // span of the document from the first to the last match
+    qsizetype length   = 0;
+    QString text;           // what the span becomes
+    int count = 0;
+};
+
+// Invalid if the pattern is not a valid regular expression
+QRegularExpression expression(const Options& options);
+
+// Finds the non-empty matches in text, handing them to onBatch in document order, a batch at a time. onBatch
+// is told whether the batch is the last one and stops the scan by returning false. At most maxMatches are
+// reported.
+void scan(const QString& text, const QRegularExpression& expression, qsizetype maxMatches,
+    const std::function<bool(const QList<Match>& batch, bool last)>& onBatch);
+
+// The replacement for one match; for regular expressions \0 to \9 refer to its captures
+QString expand(const QRegularExpressionMatch& match, const QString& replacement, bool regex);
+
+// Replaces every match in text; shouldStop is polled to abandon the work
+Replacement replaceAll(const QString& text, const QRegularExpression& expression, const QString& replacement,
+    bool regex, const std::function<bool()>& shouldStop);
+
+}
@@ -0,0 +1,158 @@
+#include "ThumbnailCache.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QMimeDatabase>
+#include <QSaveFile>
+
+namespace {
+constexpr int JPEG_QUALITY = 85;
+
+// Thumbnails are encoded in one of these; the file name of a disk entry ends in its format's suffix
+struct Format {
+    const char* suffix;
+    const char* mimeType;
+};
+constexpr Format PNG { ".png", "image/png" };
+constexpr Format JPEG { ".jpg", "image/jpeg" };
+}
+
+ThumbnailCache::ThumbnailCache(const QString& diskDirectory, const qsizetype memoryBudget, const qint64 diskBudget)
+    : m_diskDirectory(diskDirectory)
+    , m_diskBudget(diskBudget)
+    , m_memory(memoryBudget)
+{
+    QDir().mkpath(m_diskDirectory);
+}
+
+ThumbnailCache::Image ThumbnailCache::thumbnail(const QString& filePath, const int width)
+{
+    const QByteArray hash = contentHash(filePath);
+    if (hash.isEmpty()) {
+        return {};
+    }
+
+    const QString key = QString("%1_%2").arg(QString::fromLatin1(hash.toHex())).arg(width);
+    {
+        QMutexLocker lock(&m_mutex);
+        if (const Image* cached = m_memory.object(key)) {
+            return *cached;
+        }
+    }
+
+    Image image;
+    for (const Format& format : { JPEG, PNG }) {
+        if (QFile diskFile(m_diskDirectory + "/" + key + format.suffix); diskFile.open(QIODevice::ReadOnly)) {
+            image = { diskFile.readAll(), format.mimeType };
+            break;
+        }
+    }
+
+    if (image.data.isEmpty()) {
+        // Already small enough: the original bytes are served as they are, and not copied into the cache
+        QImageReader reader(filePath);
+        if (const QSize size = reader.size(); size.isValid() && size.width() <= width) {
+            QFile file(filePath);
+            if (!file.open(QIODevice::ReadOnly)) {
+                return {};
+            }
+            return { file.readAll(), QMimeDatabase().mimeTypeForFile(filePath).name().toLatin1() };
+        }
+
+        image = scale(filePath, width);
+        if (image.data.isEmpty()) {
+            return {};
+        }
+        QSaveFile out(m_diskDirectory + "/" + key + (image.mimeType == PNG.mimeType ? PNG.suffix : JPEG.suffix));
+        if (out.open(QIODevice::WriteOnly)) {
+            out.write(image.data);
+            out.commit();
+        }
+    }
+
+    QMutexLocker lock(&m_mutex);
+    m_memory.insert(key, new Image(image), image.data.size());
+    return image;
+}
+
+QByteArray ThumbnailCache::contentHash(const QString& filePath)
+{
+    const QFileInfo info(filePath);
+    if (!info.isFile()) {
+        return {};
+    }
+
+    {
+        QMutexLocker lock(&m_mutex);
+        const auto it = m_stamps.constFind(filePath);
+        if (it != m_stamps.cend() && it->size == info.size() && it->modified == info.lastModified()) {
+            return it->hash;
+        }
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    QCryptographicHash hasher(QCryptographicHash::Sha1);
+    hasher.addData(&file);
+
+    FileStamp stamp { info.size(), info.lastModified(), hasher.result() };
+    QMutexLocker lock(&m_mutex);
+    m_stamps.insert(filePath, stamp);
+    return stamp.hash;
+}
+
+ThumbnailCache::Image ThumbnailCache::scale(const QString& filePath, const int width)
+{
+    QImageReader reader(filePath);
+    reader.setAutoTransform(true);
+    const QSize size = reader.size();
+
+    // Let the decoder scale where it can (JPEG decodes at a fraction of the full size)
+    if (size.isValid()) {
+        reader.setScaledSize(size.scaled(width, size.height(), Qt::KeepAspectRatio));
+    }
+    QImage image = reader.read();
+    if (image.isNull()) {
+        return {};
+    }
+    if (image.width() > width) {
+        image = image.scaledToWidth(width, Qt::SmoothTransformation);
+    }
+
+    Image result;
+    QBuffer buffer(&result.data);
+    buffer.open(QIODevice::WriteOnly);
+    if (image.hasAlphaChannel()) {
+        image.save(&buffer, "PNG");
+        result.mimeType = PNG.mimeType;
+    } else {
+        image.save(&buffer, "JPEG", JPEG_QUALITY);
+        result.mimeType = JPEG.mimeType;
+    }
+    return result;
+}
+
+void ThumbnailCache::pruneDisk() const
+{
+    QFileInfoList entries = QDir(m_diskDirectory).entryInfoList(QDir::Files, QDir::Time);
+
+    qint64 total = 0;
+    for (const QFileInfo& entry : entries) {
+        total += entry.size();
+    }
+
+    // Newest first, so delete from the back
+    while (total > m_diskBudget && !entries.isEmpty()) {
+        const QFileInfo oldest = entries.takeLast();
+        if (QFile::remove(oldest.absoluteFilePath())) {
+            total -= oldest.size();
+        }
+    }
+}
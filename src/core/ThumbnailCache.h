@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QByteArray>
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+// Downscaled copies of local images by content hash and width, in memory and on disk; thread-safe
+class ThumbnailCache {
+public:
+    struct Image {
+        QByteArray data;
+        QByteArray mimeType;
+    };
+
+    ThumbnailCache(const QString& diskDirectory, qsizetype memoryBudget, qint64 diskBudget);
+
+    // Encoded image no wider than width, the original if it already is, or an empty image if the file cannot be read
+    Image thumbnail(const QString& filePath, int width);
+
+    // Deletes the least recently written disk entries until the cache fits the disk budget
+    void pruneDisk() const;
+
+private:
+    struct FileStamp {
+        qint64 size = -1;
+        QDateTime modified;
+        QByteArray hash;
+    };
+
+    QByteArray contentHash(const QString& filePath);
+    static Image scale(const QString& filePath, int width);
+
+    QString m_diskDirectory;
+    qint64 m_diskBudget;
+    QMutex m_mutex;
+    QHash<QString, FileStamp> m_stamps;
+    QCache<QString, Image> m_memory;
+};
@@ -0,0 +1,314 @@
+#include "UndoLog.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QSaveFile>
+
+#include <algorithm>
+
+namespace {
+constexpr quint32 MAGIC           = 0x4d4f4e55; // "MONU"
+constexpr quint32 FORMAT_VERSION  = 1;
+constexpr qint64 MERGE_INTERVAL   = 1000;       // typing faster than this ends up in one step
+constexpr int MAX_LEVEL           = 4;          // a coarsened step spans at most 2^MAX_LEVEL original steps
+constexpr qsizetype EDIT_OVERHEAD = 64;         // rough bookkeeping cost of an edit beyond its text
+constexpr qsizetype STEP_OVERHEAD = 48;
+
+bool isNoOp(const UndoLog::Edit& edit) { return edit.removed == edit.inserted; }
+
+bool containsLineBreak(const QString& text)
+{
+    return text.contains(QChar::LineFeed) || text.contains(QChar::ParagraphSeparator);
+}
+
+// Combines two consecutive edits into one if b touches the text a inserted
+std::optional<UndoLog::Edit> compose(const UndoLog::Edit& a, const UndoLog::Edit& b)
+{
+    const qsizetype aEnd = a.position + a.inserted.size(); // end of a's text after a
+    const qsizetype bEnd = b.position + b.removed.size();  // end of b's removed text, in the same coordinates
+    if (b.position > aEnd || bEnd < a.position) {
+        return std::nullopt;
+    }
+
+    UndoLog::Edit edit;
+    edit.position = std::min(a.position, b.position);
+    // Text b removed outside a's insertion was original text; a's insertion is replaced by what a removed
+    edit.removed = (b.position < a.position ? b.removed.left(a.position - b.position) : QString()) + a.removed
+        + (bEnd > aEnd ? b.removed.mid(aEnd - b.position) : QString());
+    // Text a inserted outside b's removal survives around b's insertion
+    edit.inserted = (a.position < b.position ? a.inserted.left(b.position - a.position) : QString()) + b.inserted
+        + (aEnd > bEnd ? a.inserted.mid(bEnd - a.position) : QString());
+
+    // Typing something and deleting it again leaves nothing behind
+    const qsizetype shorter = std::min(edit.removed.size(), edit.inserted.size());
+    qsizetype prefix        = 0;
+    while (prefix < shorter && edit.removed[prefix] == edit.inserted[prefix]) {
+        ++prefix;
+    }
+    qsizetype suffix = 0;
+    while (suffix < shorter - prefix
+        && edit.removed[edit.removed.size() - 1 - suffix] == edit.inserted[edit.inserted.size() - 1 - suffix]) {
+        ++suffix;
+    }
+    edit.position += prefix;
+    edit.removed  = edit.removed.mid(prefix, edit.removed.size() - prefix - suffix);
+    edit.inserted = edit.inserted.mid(prefix, edit.inserted.size() - prefix - suffix);
+    return edit;
+}
+
+void writeSteps(QDataStream& stream, const QList<UndoLog::Step>& steps)
+{
+    stream << static_cast<qint32>(steps.size());
+    for (const UndoLog::Step& step : steps) {
+        stream << step.time << static_cast<qint32>(step.level) << static_cast<qint32>(step.edits.size());
+        for (const UndoLog::Edit& edit : step.edits) {
+            stream << static_cast<qint64>(edit.position) << edit.removed << edit.inserted;
+        }
+    }
+}
+
+bool readSteps(QDataStream& stream, QList<UndoLog::Step>& steps)
+{
+    qint32 count = 0;
+    stream >> count;
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        UndoLog::Step step;
+        qint32 level = 0;
+        qint32 edits = 0;
+        stream >> step.time >> level >> edits;
+        step.level = level;
+        for (qint32 j = 0; j < edits && stream.status() == QDataStream::Ok; ++j) {
+            qint64 position = 0;
+            UndoLog::Edit edit;
+            stream >> position >> edit.removed >> edit.inserted;
+            if (position < 0) {
+                return false;
+            }
+            edit.position = position;
+            step.edits.append(edit);
+        }
+        steps.append(step);
+    }
+    return count >= 0 && stream.status() == QDataStream::Ok;
+}
+}
+
+qsizetype UndoLog::cost(const Step& step)
+{
+    qsizetype bytes = STEP_OVERHEAD;
+    for (const Edit& edit : step.edits) {
+        bytes += EDIT_OVERHEAD + (edit.removed.size() + edit.inserted.size()) * static_cast<qsizetype>(sizeof(QChar));
+    }
+    return bytes;
+}
+
+void UndoLog::compact(QList<Edit>& edits)
+{
+    QList<Edit> result;
+    for (const Edit& edit : edits) {
+        if (!result.isEmpty()) {
+            if (auto composed = compose(result.last(), edit)) {
+                result.last() = *composed;
+                if (isNoOp(result.last())) {
+                    result.removeLast();
+                }
+                continue;
+            }
+        }
+        if (!isNoOp(edit)) {
+            result.append(edit);
+        }
+    }
+    edits = result;
+}
+
+void UndoLog::updateCost()
+{
+    m_cost = 0;
+    for (const Step& step : m_undo) {
+        m_cost += cost(step);
+    }
+    for (const Step& step : m_redo) {
+        m_cost += cost(step);
+    }
+}
+
+void UndoLog::record(const qsizetype position, const QString& removed, const QString& inserted)
+{
+    const Edit edit { position, removed, inserted };
+    if (isNoOp(edit)) {
+        return;
+    }
+
+    for (const Step& step : m_redo) {
+        m_cost -= cost(step);
+    }
+    m_redo.clear();
+
+    const qint64 now   = QDateTime::currentMSecsSinceEpoch();
+    const bool closing = containsLineBreak(inserted);
+
+    // Continue the current step while typing or deleting in one place
+    if (!m_stepClosed && !m_undo.isEmpty() && now - m_undo.last().time < MERGE_INTERVAL) {
+        Step& step = m_undo.last();
+        if (auto composed = compose(step.edits.last(), edit)) {
+            m_cost -= cost(step);
+            step.edits.last() = *composed;
+            step.time         = now;
+            if (isNoOp(step.edits.last())) {
+                step.edits.removeLast();
+            }
+            if (step.edits.isEmpty()) {
+                m_undo.removeLast();
+            } else {
+                m_cost += cost(step);
+            }
+            m_stepClosed = closing;
+            enforceBudget();
+            return;
+        }
+    }
+
+    const Step step { { edit }, now, 0 };
+    m_cost += cost(step);
+    m_undo.append(step);
+    m_stepClosed = closing;
+    enforceBudget();
+}
+
+std::optional<UndoLog::Step> UndoLog::takeUndo()
+{
+    if (m_undo.isEmpty()) {
+        return std::nullopt;
+    }
+    m_redo.append(m_undo.takeLast());
+    m_stepClosed = true;
+    return m_redo.last();
+}
+
+std::optional<UndoLog::Step> UndoLog::takeRedo()
+{
+    if (m_redo.isEmpty()) {
+        return std::nullopt;
+    }
+    m_undo.append(m_redo.takeLast());
+    m_stepClosed = true;
+    return m_undo.last();
+}
+
+void UndoLog::clear()
+{
+    m_undo.clear();
+    m_redo.clear();
+    m_cost       = 0;
+    m_stepClosed = true;
+}
+
+void UndoLog::setMemoryBudget(const qsizetype bytes)
+{
+    m_memoryBudget = std::max<qsizetype>(bytes, 0);
+    enforceBudget();
+}
+
+void UndoLog::prepend(UndoLog older)
+{
+    if (m_undo.isEmpty() && m_redo.isEmpty()) {
+        m_redo = std::move(older.m_redo);
+    }
+    m_undo = std::move(older.m_undo) + m_undo;
+    updateCost();
+    enforceBudget();
+}
+
+bool UndoLog::coarsen()
+{
+    // Only the older half is coarsened; recent steps keep their granularity
+    const qsizetype older = m_undo.size() / 2;
+    bool merged           = false;
+
+    QList<Step> steps;
+    for (qsizetype i = 0; i < older;) {
+        const Step& first = m_undo[i];
+        if (i + 1 < older && first.level < MAX_LEVEL && m_undo[i + 1].level < MAX_LEVEL) {
+            const Step& second = m_undo[i + 1];
+            Step step { first.edits + second.edits, second.time, std::max(first.level, second.level) + 1 };
+            compact(step.edits);
+            if (!step.edits.isEmpty()) {
+                steps.append(step);
+            }
+            merged = true;
+            i += 2;
+        } else {
+            steps.append(first);
+            ++i;
+        }
+    }
+    if (!merged) {
+        return false;
+    }
+
+    steps.append(m_undo.mid(older));
+    m_undo = steps;
+    updateCost();
+    return true;
+}
+
+void UndoLog::enforceBudget()
+{
+    if (m_cost <= m_memoryBudget) {
+        return;
+    }
+
+    // Trim below the budget so this does not run again on the next keystroke
+    const qsizetype target = m_memoryBudget / 4 * 3;
+    while (m_cost > target && coarsen()) { }
+    while (m_cost > target && !m_undo.isEmpty()) {
+        m_cost -= cost(m_undo.takeFirst());
+    }
+    while (m_cost > target && !m_redo.isEmpty()) {
+        m_cost -= cost(m_redo.takeFirst());
+    }
+}
+
+bool UndoLog::save(const QString& path, const QString& text) const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << MAGIC << FORMAT_VERSION << QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1);
+    writeSteps(stream, m_undo);
+    writeSteps(stream, m_redo);
+
+    const QByteArray compressed = qCompress(data);
+    QSaveFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(compressed) == compressed.size() && file.commit();
+}
+
+std::optional<UndoLog> UndoLog::load(const QString& path, const QString& text)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return std::nullopt;
+    }
+
+    const QByteArray data = qUncompress(file.readAll());
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_6_0);
+    quint32 magic   = 0;
+    quint32 version = 0;
+    QByteArray hash;
+    stream >> magic >> version >> hash;
+    if (magic != MAGIC || version != FORMAT_VERSION
+        || hash != QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1)) {
+        return std::nullopt;
+    }
+
+    UndoLog log;
+    if (!readSteps(stream, log.m_undo) || !readSteps(stream, log.m_redo)) {
+        return std::nullopt;
+    }
+    log.updateCost();
+    return log;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+
+#include <optional>
+
+// Undo history of the notes editor, bounded by memory; older steps are merged before any are dropped
+class UndoLog {
+public:
+    static constexpr qsizetype DEFAULT_MEMORY_BUDGET = 8 * 1024 * 1024;
+
+    struct Edit {
+        qsizetype position = 0;
+        QString removed;
+        QString inserted;
+    };
+
+    struct Step {
+        QList<Edit> edits; // in the order they were applied
+        qint64 time = 0;   // msecs since epoch of the last edit
+        int level   = 0;   // how often the step was merged with a neighbour to save memory
+    };
+
+    // Records that `removed` was replaced by `inserted` at position; clears the redo stack
+    void record(qsizetype position, const QString& removed, const QString& inserted);
+
+    // Makes the next record() start a new step
+    void closeStep() { m_stepClosed = true; }
+
+    // Moves the newest undo step to the redo stack and returns it; undo its edits in reverse order
+    std::optional<Step> takeUndo();
+
+    // Moves the newest redo step back to the undo stack and returns it; redo its edits in order
+    std::optional<Step> takeRedo();
+
+    [[nodiscard]] bool canUndo() const { return !m_undo.isEmpty(); }
+    [[nodiscard]] bool canRedo() const { return !m_redo.isEmpty(); }
+
+    void clear();
+
+    void setMemoryBudget(qsizetype bytes);
+
+    // Puts the steps of an older log underneath this one. Its redo steps are kept only if this log is empty.
+    void prepend(UndoLog older);
+
+    // Writes the log for the given document text; does file I/O, so it can be called from a worker
+    [[nodiscard]] bool save(const QString& path, const QString& text) const;
+
+    // Reads a log written by save(); fails if it was saved for a different text
+    static std::optional<UndoLog> load(const QString& path, const QString& text);
+
+private:
+    static qsizetype cost(const Step& step);
+    static void compact(QList<Edit>& edits);
+    void updateCost();
+    void enforceBudget();
+    bool coarsen();
+
+    QList<Step> m_undo; // oldest first
+    QList<Step> m_redo; // the next step to redo last
+    qsizetype m_cost         = 0;
+    qsizetype m_memoryBudget = DEFAULT_MEMORY_BUDGET;
+    bool m_stepClosed        = true;
+};
@@ -0,0 +1,428 @@
+#include "FindReplaceBar.h"
+
+#include <QApplication>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QPointer>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QThreadPool>
+#include <QVBoxLayout>
+
+#include <algorithm>
+
+namespace {
+constexpr int SEARCH_DELAY         = 150; // ms after the last keystroke in the find field
+constexpr qsizetype MAX_HIGHLIGHTS = 2000;
+const QColor MATCH_COLOR(250, 189, 47, 90); // Gruvbox yellow
+const QColor CURRENT_MATCH_COLOR(254, 128, 25, 170);
+
+QToolButton* createToggle(const QString& text, const QString& toolTip, QWidget* parent)
+{
+    auto* button = new QToolButton(parent);
+    button->setText(text);
+    button->setToolTip(toolTip);
+    button->setCheckable(true);
+    button->setAutoRaise(true);
+    return button;
+}
+
+QToolButton* createButton(const QString& text, const QString& toolTip, QWidget* parent)
+{
+    auto* button = new QToolButton(parent);
+    button->setText(text);
+    button->setToolTip(toolTip);
+    button->setAutoRaise(true);
+    return button;
+}
+
+// The text snapshot has U+2029 between blocks; patterns expect line feeds, which keeps the positions the same
+QString searchableText(QString text)
+{
+    text.replace(QChar::ParagraphSeparator, QChar::LineFeed);
+    return text;
+}
+}
+
+FindReplaceBar::FindReplaceBar(NotesTextEdit* editor, QWidget* parent)
+    : QWidget(parent)
+    , m_editor(editor)
+    , m_findEdit(new QLineEdit(this))
+    , m_replaceEdit(new QLineEdit(this))
+    , m_caseButton(createToggle("Aa", tr("Match case"), this))
+    , m_regexButton(createToggle(".*", tr("Regular expression"), this))
+    , m_wordsButton(createToggle("W", tr("Whole words"), this))
+    , m_status(new QLabel(this))
+    , m_replaceRow(new QWidget(this))
+    , m_searchTimer(new QTimer(this))
+{
+    m_findEdit->setPlaceholderText(tr("Find"));
+    m_findEdit->setClearButtonEnabled(true);
+    m_replaceEdit->setPlaceholderText(tr("Replace"));
+    m_findEdit->installEventFilter(this);
+    m_replaceEdit->installEventFilter(this);
+    m_editor->viewport()->installEventFilter(this);
+
+    auto* previousButton   = createButton("↑", tr("Previous match (Shift+F3)"), this);
+    auto* nextButton       = createButton("↓", tr("Next match (F3)"), this);
+    auto* closeButton      = createButton("✕", tr("Close (Esc)"), this);
+    auto* replaceButton    = createButton(tr("Replace"), tr("Replace the selected match"), m_replaceRow);
+    auto* replaceAllButton = createButton(tr("Replace All"), tr("Replace every match as one edit"), m_replaceRow);
+
+    auto* findRow = new QHBoxLayout();
+    findRow->addWidget(m_findEdit, 1);
+    findRow->addWidget(m_caseButton);
+    findRow->addWidget(m_wordsButton);
+    findRow->addWidget(m_regexButton);
+    findRow->addWidget(m_status);
+    findRow->addWidget(previousButton);
+    findRow->addWidget(nextButton);
+    findRow->addWidget(closeButton);
+
+    auto* replaceRow = new QHBoxLayout(m_replaceRow);
+    replaceRow->setContentsMargins(0, 0, 0, 0);
+    replaceRow->addWidget(m_replaceEdit, 1);
+    replaceRow->addWidget(replaceButton);
+    replaceRow->addWidget(replaceAllButton);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 2, 4, 2);
+    layout->setSpacing(2);
+    layout->addLayout(findRow);
+    layout->addWidget(m_replaceRow);
+
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(SEARCH_DELAY);
+
+    // A new pattern selects its first match after the cursor
+    const auto patternChanged = [this] {
+        m_origin        = m_editor->textCursor().selectionStart();
+        m_selectPending = true;
+        m_searchTimer->start();
+    };
+    connect(m_findEdit, &QLineEdit::textChanged, this, patternChanged);
+    connect(m_caseButton, &QToolButton::toggled, this, patternChanged);
+    connect(m_regexButton, &QToolButton::toggled, this, patternChanged);
+    connect(m_wordsButton, &QToolButton::toggled, this, patternChanged);
+    connect(m_searchTimer, &QTimer::timeout, this, &FindReplaceBar::startSearch);
+
+    connect(previousButton, &QToolButton::clicked, this, &FindReplaceBar::findPrevious);
+    connect(nextButton, &QToolButton::clicked, this, &FindReplaceBar::findNext);
+    connect(closeButton, &QToolButton::clicked, this, &FindReplaceBar::dismiss);
+    connect(replaceButton, &QToolButton::clicked, this, &FindReplaceBar::replaceCurrent);
+    connect(replaceAllButton, &QToolButton::clicked, this, &FindReplaceBar::replaceAll);
+
+    // Edits make the matches stale; search again once typing pauses, without moving the cursor
+    connect(m_editor->document(), &QTextDocument::contentsChange, this, [this] {
+        if (isVisible() && m_editor->textRevision() != m_revision) {
+            ++*m_generation;
+            m_matches.clear();
+            m_text.clear();
+            m_revision = m_editor->textRevision();
+            updateHighlights();
+            m_searchTimer->start();
+        }
+    });
+    connect(m_editor->verticalScrollBar(), &QScrollBar::valueChanged, this, &FindReplaceBar::updateHighlights);
+    connect(m_editor, &QPlainTextEdit::cursorPositionChanged, this, [this] {
+        if (isVisible()) {
+            updateHighlights();
+            updateStatus();
+        }
+    });
+}
+
+FindReplaceBar::~FindReplaceBar()
+{
+    // Let running scans stop early
+    ++*m_generation;
+}
+
+void FindReplaceBar::activate(const bool replace)
+{
+    const bool wasVisible = isVisible();
+    show();
+    m_replaceRow->setVisible(replace);
+
+    // Seed the pattern with a single-line selection
+    const QString selected = m_editor->textCursor().selectedText();
+    if (!selected.isEmpty() && !selected.contains(QChar::ParagraphSeparator) && selected != m_findEdit->text()) {
+        m_findEdit->setText(selected);
+    } else if (!wasVisible) {
+        m_origin        = m_editor->textCursor().selectionStart();
+        m_selectPending = true;
+        startSearch();
+    }
+    m_findEdit->selectAll();
+    m_findEdit->setFocus();
+}
+
+void FindReplaceBar::dismiss()
+{
+    ++*m_generation;
+    m_searchTimer->stop();
+    m_matches.clear();
+    m_searching = false;
+    hide();
+    m_editor->setExtraSelections({});
+    m_editor->setFocus();
+}
+
+TextSearch::Options FindReplaceBar::options() const
+{
+    TextSearch::Options options;
+    options.pattern       = m_findEdit->text();
+    options.regex         = m_regexButton->isChecked();
+    options.caseSensitive = m_caseButton->isChecked();
+    options.wholeWords    = m_wordsButton->isChecked();
+    return options;
+}
+
+void FindReplaceBar::startSearch()
+{
+    m_searchTimer->stop();
+    const int generation = ++*m_generation;
+    m_matches.clear();
+    m_revision   = m_editor->textRevision();
+    m_expression = TextSearch::expression(options());
+    m_searching  = !m_findEdit->text().isEmpty() && m_expression.isValid();
+    m_text       = m_searching ? searchableText(m_editor->rawText()) : QString();
+    updateHighlights();
+    updateStatus();
+    if (!m_searching) {
+        return;
+    }
+
+    QThreadPool::globalInstance()->start([bar = QPointer(this), counter = m_generation, generation,
+                                             expression = m_expression, text = m_text] {
+        TextSearch::scan(text, expression, MAX_MATCHES,
+            [&](const QList<TextSearch::Match>& batch, const bool last) {
+                if (*counter != generation) {
+                    return false;
+                }
+                QMetaObject::invokeMethod(qApp, [bar, counter, generation, batch, last] {
+                    if (!bar.isNull() && *counter == generation) {
+                        bar->addMatches(batch, last);
+                    }
+                });
+                return true;
+            });
+    });
+}
+
+void FindReplaceBar::addMatches(const QList<TextSearch::Match>& batch, const bool last)
+{
+    const qsizetype offset = m_matches.size();
+    m_matches.append(batch);
+    m_searching = !last;
+
+    if (m_selectPending) {
+        const auto it = std::find_if(batch.cbegin(), batch.cend(),
+            [this](const TextSearch::Match& match) { return match.position >= m_origin; });
+        if (it != batch.cend()) {
+            selectMatch(offset + (it - batch.cbegin()));
+        } else if (last && !m_matches.isEmpty()) {
+            selectMatch(0); // nothing after the cursor, wrap around
+        }
+    }
+
+    updateHighlights();
+    updateStatus();
+}
+
+void FindReplaceBar::selectMatch(const qsizetype index)
+{
+    m_selectPending = false;
+    const TextSearch::Match& match = m_matches[index];
+    QTextCursor cursor(m_editor->document());
+    cursor.setPosition(static_cast<int>(match.position));
+    cursor.setPosition(static_cast<int>(match.position + match.length), QTextCursor::KeepAnchor);
+    m_editor->setTextCursor(cursor);
+}
+
+qsizetype FindReplaceBar::firstMatchFrom(const qsizetype position) const
+{
+    const auto it = std::lower_bound(m_matches.cbegin(), m_matches.cend(), position,
+        [](const TextSearch::Match& match, const qsizetype from) { return match.position < from; });
+    return it - m_matches.cbegin();
+}
+
+qsizetype FindReplaceBar::currentMatch() const
+{
+    const QTextCursor cursor = m_editor->textCursor();
+    const qsizetype index    = firstMatchFrom(cursor.selectionStart());
+    if (index == m_matches.size() || m_matches[index].position != cursor.selectionStart()
+        || m_matches[index].position + m_matches[index].length != cursor.selectionEnd()) {
+        return -1;
+    }
+    return index;
+}
+
+void FindReplaceBar::findNext()
+{
+    if (m_matches.isEmpty()) {
+        return;
+    }
+    const qsizetype index = firstMatchFrom(m_editor->textCursor().selectionEnd());
+    selectMatch(index == m_matches.size() ? 0 : index);
+}
+
+void FindReplaceBar::findPrevious()
+{
+    if (m_matches.isEmpty()) {
+        return;
+    }
+    const qsizetype index = firstMatchFrom(m_editor->textCursor().selectionStart());
+    selectMatch(index == 0 ? m_matches.size() - 1 : index - 1);
+}
+
+void FindReplaceBar::replaceCurrent()
+{
+    if (m_replacingAll || m_findEdit->text().isEmpty() || !m_expression.isValid()) {
+        return;
+    }
+    const qsizetype index = currentMatch();
+    if (index < 0) {
+        findNext();
+        return;
+    }
+
+    // Match again in context so captures and lookarounds see the whole text
+    const TextSearch::Match match       = m_matches[index];
+    const QRegularExpressionMatch found = m_expression.match(m_text, match.position,
+        QRegularExpression::NormalMatch, QRegularExpression::AnchorAtOffsetMatchOption);
+    if (!found.hasMatch() || found.capturedLength() != match.length) {
+        startSearch();
+        return;
+    }
+
+    QTextCursor cursor = m_editor->textCursor();
+    const QString replacement = TextSearch::expand(found, m_replaceEdit->text(), m_regexButton->isChecked());
+    m_editor->editAsStep(cursor, [&] { cursor.insertText(replacement); });
+    m_editor->setTextCursor(cursor);
+
+    // Move on to the next match once the search has caught up with the edit
+    m_origin        = cursor.position();
+    m_selectPending = true;
+}
+
+void FindReplaceBar::replaceAll()
+{
+    const TextSearch::Options options   = this->options();
+    const QRegularExpression expression = TextSearch::expression(options);
+    if (m_replacingAll || options.pattern.isEmpty() || !expression.isValid()) {
+        return;
+    }
+    m_replacingAll = true;
+    m_status->setText(tr("Replacing..."));
+
+    // Any edit in the meantime bumps the generation and abandons the replacement
+    QThreadPool::globalInstance()->start(
+        [bar = QPointer(this), counter = m_generation, generation = m_generation->load(),
+            revision = m_editor->textRevision(), expression, replacement = m_replaceEdit->text(),
+            regex = options.regex, text = searchableText(m_editor->rawText())] {
+            const TextSearch::Replacement result = TextSearch::replaceAll(text, expression, replacement, regex,
+                [&] { return *counter != generation; });
+            QMetaObject::invokeMethod(qApp, [bar, counter, generation, revision, result] {
+                if (bar.isNull()) {
+                    return;
+                }
+                bar->m_replacingAll = false;
+                if (*counter != generation || bar->m_editor->textRevision() != revision) {
+                    bar->updateStatus();
+                    return;
+                }
+                if (result.count > 0) {
+                    // One edit: a single contentsChange, undo step and re-highlight of the span
+                    bar->m_editor->replaceRange(static_cast<int>(result.position),
+                        static_cast<int>(result.length), result.text);
+                }
+                bar->m_status->setText(tr("Replaced %n match(es)", nullptr, result.count));
+            });
+        });
+}
+
+void FindReplaceBar::updateHighlights()
+{
+    QList<QTextEdit::ExtraSelection> selections;
+    if (isVisible() && !m_matches.isEmpty()) {
+        // Only the matches between the first and the last visible character
+        const QRect viewport = m_editor->viewport()->rect();
+        const int first      = m_editor->cursorForPosition(viewport.topLeft()).position();
+        QTextCursor last     = m_editor->cursorForPosition(viewport.bottomRight());
+        last.movePosition(QTextCursor::EndOfBlock);
+
+        // Matches do not overlap, so their ends are ordered too
+        auto it = std::lower_bound(m_matches.cbegin(), m_matches.cend(), first,
+            [](const TextSearch::Match& match, const int from) { return match.position + match.length <= from; });
+        const qsizetype current = currentMatch();
+        for (; it != m_matches.cend() && it->position <= last.position() && selections.size() < MAX_HIGHLIGHTS;
+            ++it) {
+            QTextEdit::ExtraSelection selection;
+            selection.cursor = QTextCursor(m_editor->document());
+            selection.cursor.setPosition(static_cast<int>(it->position));
+            selection.cursor.setPosition(static_cast<int>(it->position + it->length), QTextCursor::KeepAnchor);
+            selection.format.setBackground(it - m_matches.cbegin() == current ? CURRENT_MATCH_COLOR : MATCH_COLOR);
+            selections.append(selection);
+        }
+    }
+    m_editor->setExtraSelections(selections);
+}
+
+void FindReplaceBar::updateStatus()
+{
+    if (m_replacingAll) {
+        return;
+    }
+    if (m_findEdit->text().isEmpty()) {
+        m_status->clear();
+    } else if (!m_expression.isValid()) {
+        m_status->setText(tr("Invalid expression"));
+    } else if (m_searching) {
+        m_status->setText(tr("%n match(es)...", nullptr, static_cast<int>(m_matches.size())));
+    } else if (m_matches.isEmpty()) {
+        m_status->setText(tr("No matches"));
+    } else {
+        const qsizetype current = currentMatch();
+        const QString count     = m_matches.size() >= MAX_MATCHES ? QString("%1+").arg(MAX_MATCHES)
+                                                                  : QString::number(m_matches.size());
+        m_status->setText(current < 0 ? tr("%1 matches").arg(count) : tr("%1 of %2").arg(current + 1).arg(count));
+    }
+}
+
+bool FindReplaceBar::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched == m_editor->viewport()) {
+        if (event->type() == QEvent::Resize) {
+            updateHighlights();
+        }
+        return false;
+    }
+
+    if (event->type() == QEvent::KeyPress) {
+        const auto* keyEvent = static_cast<QKeyEvent*>(event);
+        if (keyEvent->key() == Qt::Key_Escape) {
+            dismiss();
+            return true;
+        }
+        if (keyEvent->key() == Qt::Key_Return || keyEvent->key() == Qt::Key_Enter) {
+            if (watched == m_replaceEdit) {
+                replaceCurrent();
+            } else if (keyEvent->modifiers() & Qt::ShiftModifier) {
+                findPrevious();
+            } else {
+                findNext();
+            }
+            return true;
+        }
+        if (keyEvent->matches(QKeySequence::FindNext)) {
+            findNext();
+            return true;
+        }
+        if (keyEvent->matches(QKeySequence::FindPrevious)) {
+            findPrevious();
+            return true;
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "NotesTextEdit.h"
+#include "core/TextSearch.h"
+
+#include <QLabel>
+#include <QLineEdit>
+#include <QTimer>
+#include <QToolButton>
+#include <QWidget>
+
+#include <atomic>
+#include <memory>
+
+// Find and replace bar for the notes editor; searches and Replace All run on the global thread pool
+class FindReplaceBar final : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit FindReplaceBar(NotesTextEdit* editor, QWidget* parent = nullptr);
+    ~FindReplaceBar() override;
+
+    // Shows the bar, seeded with the selected text
+    void activate(bool replace);
+
+public slots:
+    void findNext();
+    void findPrevious();
+    void replaceCurrent();
+    void replaceAll();
+    void dismiss();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    void startSearch();
+    void addMatches(const QList<TextSearch::Match>& batch, bool last);
+    void selectMatch(qsizetype index);
+    void updateHighlights();
+    void updateStatus();
+    [[nodiscard]] TextSearch::Options options() const;
+    [[nodiscard]] qsizetype firstMatchFrom(qsizetype position) const;
+    [[nodiscard]] qsizetype currentMatch() const; // index of the selected match, or -1
+
+    NotesTextEdit* m_editor;
+    QLineEdit* m_findEdit;
+    QLineEdit* m_replaceEdit;
+    QToolButton* m_caseButton;
+    QToolButton* m_regexButton;
+    QToolButton* m_wordsButton;
+    QLabel* m_status;
+    QWidget* m_replaceRow;
+    QTimer* m_searchTimer;
+    std::shared_ptr<std::atomic_int> m_generation = std::make_shared<std::atomic_int>(0); // of the current search
+    QRegularExpression m_expression;
+    QList<TextSearch::Match> m_matches;
+    QString m_text; // searchable copy of the text the matches were found in, dropped with them on an edit
+    quint64 m_revision   = 0;     // text revision the matches belong to
+    int m_origin         = 0;     // the first match at or after this position gets selected
+    bool m_searching     = false;
+    bool m_selectPending = false; // no match was selected for the current search yet
+    bool m_replacingAll  = false;
+    static constexpr qsizetype MAX_MATCHES = 100000;
+};
@@ -0,0 +1,226 @@
+#include "HistoryDialog.h"
+
+#include <QApplication>
+#include <QDialogButtonBox>
+#include <QFontDatabase>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPointer>
+#include <QSplitter>
+#include <QTextBlock>
+#include <QThreadPool>
+#include <QVBoxLayout>
+
+namespace {
+constexpr int CONTEXT_LINES     = 3;
+constexpr int MAX_DISPLAY_LINES = 20000;
+
+enum CompareMode {
+    CompareWithPrevious,
+    CompareWithCurrent,
+};
+}
+
+// Keeps changed lines plus some context
+QList<HistoryDialog::DisplayLine> HistoryDialog::hunks(const QList<LineDiff::Line>& lines)
+{
+    QList<DisplayLine> result;
+    qsizetype lastKept = -1;
+    for (qsizetype i = 0; i < lines.size() && result.size() < MAX_DISPLAY_LINES; ++i) {
+        bool keep = lines[i].op != LineDiff::Op::Equal;
+        for (qsizetype j = std::max<qsizetype>(0, i - CONTEXT_LINES);
+            !keep && j <= std::min(lines.size() - 1, i + CONTEXT_LINES); ++j) {
+            keep = lines[j].op != LineDiff::Op::Equal;
+        }
+        if (!keep) {
+            continue;
+        }
+        if (lastKept >= 0 && i > lastKept + 1) {
+            result.append({ '~', QString() });
+        }
+        const char marker = lines[i].op == LineDiff::Op::Insert ? '+'
+            : lines[i].op == LineDiff::Op::Delete                ? '-'
+                                                                 : ' ';
+        result.append({ marker, lines[i].text });
+        lastKept = i;
+    }
+    return result;
+}
+
+HistoryDialog::HistoryDialog(std::shared_ptr<HistoryStore> store, const QString& currentText, QWidget* parent)
+    : QDialog(parent)
+    , m_store(std::move(store))
+    , m_currentText(currentText)
+    , m_versionList(new QListWidget(this))
+    , m_compareMode(new QComboBox(this))
+    , m_diffView(new QPlainTextEdit(this))
+    , m_restoreButton(new QPushButton(tr("Restore This Version"), this))
+{
+    setWindowTitle(tr("Notes History"));
+    resize(900, 600);
+
+    m_compareMode->addItem(tr("Changes made in this version"), CompareWithPrevious);
+    m_compareMode->addItem(tr("Differences to the current notes"), CompareWithCurrent);
+
+    m_diffView->setReadOnly(true);
+    m_diffView->setLineWrapMode(QPlainTextEdit::NoWrap);
+    m_diffView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_restoreButton->setEnabled(false);
+
+    auto* splitter = new QSplitter(this);
+    splitter->addWidget(m_versionList);
+    splitter->addWidget(m_diffView);
+    splitter->setStretchFactor(1, 3);
+
+    auto* topRow = new QHBoxLayout();
+    topRow->addWidget(new QLabel(tr("Show:"), this));
+    topRow->addWidget(m_compareMode);
+    topRow->addStretch();
+
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    buttons->addButton(m_restoreButton, QDialogButtonBox::ActionRole);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->addLayout(topRow);
+    layout->addWidget(splitter);
+    layout->addWidget(buttons);
+
+    connect(m_versionList, &QListWidget::currentRowChanged, this, &HistoryDialog::onSelectionChanged);
+    connect(m_compareMode, &QComboBox::currentIndexChanged, this, &HistoryDialog::onSelectionChanged);
+    connect(m_restoreButton, &QPushButton::clicked, this, &HistoryDialog::restoreSelected);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    loadVersions();
+}
+
+void HistoryDialog::loadVersions()
+{
+    m_versionList->addItem(tr("Loading..."));
+    m_versionList->setEnabled(false);
+
+    QThreadPool::globalInstance()->start([dialog = QPointer<HistoryDialog>(this), store = m_store] {
+        const QList<HistoryStore::Version> versions = store->versions();
+
+        QMetaObject::invokeMethod(qApp, [dialog, versions] {
+            if (dialog.isNull()) {
+                return;
+            }
+            dialog->m_versionList->clear();
+            dialog->m_versionList->setEnabled(true);
+
+            // Newest first
+            for (auto it = versions.crbegin(); it != versions.crend(); ++it) {
+                auto* item = new QListWidgetItem(tr("%1  (%2 characters)")
+                        .arg(QLocale().toString(it->time, QLocale::ShortFormat))
+                        .arg(it->length));
+                item->setData(Qt::UserRole, it->id);
+                dialog->m_versionList->addItem(item);
+            }
+            if (versions.isEmpty()) {
+                dialog->m_diffView->setPlainText(tr("No versions have been recorded yet."));
+            } else {
+                dialog->m_versionList->setCurrentRow(0);
+            }
+        });
+    });
+}
+
+void HistoryDialog::onSelectionChanged()
+{
+    const int row = m_versionList->currentRow();
+    m_selectedText.reset();
+    m_restoreButton->setEnabled(false);
+    if (row < 0 || !m_versionList->isEnabled()) {
+        return;
+    }
+
+    const int id = m_versionList->item(row)->data(Qt::UserRole).toInt();
+    // The next item in the list is the previous version
+    const int previousId
+        = row + 1 < m_versionList->count() ? m_versionList->item(row + 1)->data(Qt::UserRole).toInt() : -1;
+    const bool compareWithCurrent = m_compareMode->currentData().toInt() == CompareWithCurrent;
+
+    m_diffView->setPlainText(tr("Loading..."));
+    const int generation = ++m_generation;
+
+    QThreadPool::globalInstance()->start([dialog = QPointer<HistoryDialog>(this), store = m_store,
+                                             current = m_currentText, id, previousId, compareWithCurrent,
+                                             generation] {
+        Loaded loaded;
+        if (const std::optional<QString> text = store->text(id); text.has_value()) {
+            loaded.ok   = true;
+            loaded.text = *text;
+
+            QString base;
+            if (!compareWithCurrent && previousId >= 0) {
+                base = store->text(previousId).value_or(QString());
+            }
+            const QString& before = compareWithCurrent ? *text : base;
+            const QString& after  = compareWithCurrent ? current : *text;
+            loaded.diff = hunks(LineDiff::diff(before.split('\n'), after.split('\n')));
+        }
+
+        QMetaObject::invokeMethod(qApp, [dialog, loaded, generation] {
+            if (!dialog.isNull() && dialog->m_generation == generation) {
+                dialog->showLoaded(loaded);
+            }
+        });
+    });
+}
+
+void HistoryDialog::showLoaded(const Loaded& loaded)
+{
+    m_diffView->clear();
+    if (!loaded.ok) {
+        m_diffView->setPlainText(tr("This version could not be reconstructed."));
+        return;
+    }
+
+    m_selectedText = loaded.text;
+    m_restoreButton->setEnabled(true);
+
+    if (loaded.diff.isEmpty()) {
+        m_diffView->setPlainText(tr("No differences."));
+        return;
+    }
+
+    QTextCharFormat inserted;
+    inserted.setBackground(QColor(0x98, 0x97, 0x1a, 80));
+    QTextCharFormat deleted;
+    deleted.setBackground(QColor(0xcc, 0x24, 0x1d, 80));
+    QTextCharFormat separator;
+    separator.setForeground(palette().color(QPalette::PlaceholderText));
+
+    // One edit block so the view lays out once
+    QTextCursor cursor(m_diffView->document());
+    cursor.beginEditBlock();
+    for (const DisplayLine& line : loaded.diff) {
+        if (!cursor.atStart()) {
+            cursor.insertBlock();
+        }
+        switch (line.marker) {
+        case '+':
+            cursor.insertText("+ " + line.text, inserted);
+            break;
+        case '-':
+            cursor.insertText("- " + line.text, deleted);
+            break;
+        case '~':
+            cursor.insertText("⋯", separator);
+            break;
+        default:
+            cursor.insertText("  " + line.text, QTextCharFormat());
+            break;
+        }
+    }
+    cursor.endEditBlock();
+    m_diffView->moveCursor(QTextCursor::Start);
+}
+
+void HistoryDialog::restoreSelected()
+{
+    if (m_selectedText.has_value()) {
+        emit restoreRequested(*m_selectedText);
+        accept();
+    }
+}
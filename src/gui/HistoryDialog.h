@@ -0,0 +1,53 @@
+#pragma once
+
+#include "core/HistoryStore.h"
+#include "core/LineDiff.h"
+
+#include <QComboBox>
+#include <QDialog>
+#include <QListWidget>
+#include <QPlainTextEdit>
+#include <QPushButton>
+
+#include <memory>
+
+// Browses the recorded versions of a profile's notes
+class HistoryDialog final : public QDialog {
+    Q_OBJECT
+
+public:
+    HistoryDialog(std::shared_ptr<HistoryStore> store, const QString& currentText, QWidget* parent = nullptr);
+
+signals:
+    void restoreRequested(const QString& text);
+
+private slots:
+    void onSelectionChanged();
+    void restoreSelected();
+
+private:
+    struct DisplayLine {
+        char marker; // '+', '-', ' ' for context, or '~' for skipped unchanged lines
+        QString text;
+    };
+
+    struct Loaded {
+        bool ok = false;
+        QString text;
+        QList<DisplayLine> diff; // changed lines with some context
+    };
+
+    static QList<DisplayLine> hunks(const QList<LineDiff::Line>& lines);
+
+    void loadVersions();
+    void showLoaded(const Loaded& loaded);
+
+    std::shared_ptr<HistoryStore> m_store;
+    QString m_currentText;
+    QListWidget* m_versionList;
+    QComboBox* m_compareMode;
+    QPlainTextEdit* m_diffView;
+    QPushButton* m_restoreButton;
+    std::optional<QString> m_selectedText;
+    int m_generation = 0;
+};
@@ -0,0 +1,94 @@
+#include "ImageSchemeHandler.h"
+#include "core/AttachmentStore.h"
+
+#include <QApplication>
+#include <QBuffer>
+#include <QDir>
+#include <QPointer>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QUrlQuery>
+#include <QWebEngineUrlRequestJob>
+#include <QWebEngineUrlScheme>
+
+#include <algorithm>
+
+namespace {
+constexpr qsizetype MEMORY_BUDGET = 64 * 1024 * 1024;  // bytes of encoded thumbnails
+constexpr qint64 DISK_BUDGET      = 256 * 1024 * 1024; // bytes on disk
+constexpr int MAX_WIDTH           = 4096;
+constexpr int WIDTH_STEP          = 256; // round widths up so resizing does not create new entries
+}
+
+void ImageSchemeHandler::registerScheme()
+{
+    if (QWebEngineUrlScheme::schemeByName(SCHEME).name().isEmpty()) {
+        QWebEngineUrlScheme scheme(SCHEME);
+        scheme.setSyntax(QWebEngineUrlScheme::Syntax::Host);
+        scheme.setFlags(QWebEngineUrlScheme::SecureScheme);
+        QWebEngineUrlScheme::registerScheme(scheme);
+    }
+}
+
+ImageSchemeHandler::ImageSchemeHandler(QObject* parent)
+    : QWebEngineUrlSchemeHandler(parent)
+    , m_cache(std::make_shared<ThumbnailCache>(
+          QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/mo2_notes/thumbnails", MEMORY_BUDGET,
+          DISK_BUDGET))
+{
+    QThreadPool::globalInstance()->start([cache = m_cache] { cache->pruneDisk(); });
+}
+
+QString ImageSchemeHandler::resolve(const QUrl& url) const
+{
+    if (m_profilePath.isEmpty()) {
+        return {};
+    }
+
+    QString root;
+    if (url.host() == "profile") {
+        root = QDir::cleanPath(m_profilePath);
+    } else if (url.host() == "attachments") {
+        root = QDir::cleanPath(AttachmentStore::rootForProfile(m_profilePath));
+    } else {
+        return {};
+    }
+
+    // Keep requests inside the root directory
+    const QString path = QDir::cleanPath(root + "/" + url.path());
+    if (!path.startsWith(root + "/", Qt::CaseInsensitive)) {
+        return {};
+    }
+    return path;
+}
+
+void ImageSchemeHandler::requestStarted(QWebEngineUrlRequestJob* job)
+{
+    const QString filePath = resolve(job->requestUrl());
+    if (filePath.isEmpty()) {
+        job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        return;
+    }
+
+    int width = QUrlQuery(job->requestUrl()).queryItemValue("w").toInt();
+    width     = width > 0 ? std::min(MAX_WIDTH, (width + WIDTH_STEP - 1) / WIDTH_STEP * WIDTH_STEP) : MAX_WIDTH;
+
+    // The job is owned by WebEngine and disappears if the request is cancelled
+    const QPointer<QWebEngineUrlRequestJob> guard(job);
+    QThreadPool::globalInstance()->start([cache = m_cache, guard, filePath, width] {
+        ThumbnailCache::Image image = cache->thumbnail(filePath, width);
+
+        QMetaObject::invokeMethod(qApp, [guard, image = std::move(image)] {
+            if (guard.isNull()) {
+                return;
+            }
+            if (image.data.isEmpty()) {
+                guard->fail(QWebEngineUrlRequestJob::UrlNotFound);
+                return;
+            }
+            auto* const buffer = new QBuffer(guard.data());
+            buffer->setData(image.data);
+            guard->reply(image.mimeType, buffer);
+        });
+    });
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "core/ThumbnailCache.h"
+
+#include <QWebEngineUrlSchemeHandler>
+
+#include <memory>
+
+// Serves notes-img://profile/<relative path>?w=<width> to the preview, downscaled and cached
+class ImageSchemeHandler final : public QWebEngineUrlSchemeHandler {
+    Q_OBJECT
+
+public:
+    static constexpr auto SCHEME = "notes-img";
+
+    // Must run before Qt WebEngine is initialized, i.e. while the plugin is loading
+    static void registerScheme();
+
+    explicit ImageSchemeHandler(QObject* parent = nullptr);
+
+    void setProfilePath(const QString& profilePath) { m_profilePath = profilePath; }
+
+    void requestStarted(QWebEngineUrlRequestJob* job) override;
+
+private:
+    [[nodiscard]] QString resolve(const QUrl& url) const;
+
+    QString m_profilePath;
+    std::shared_ptr<ThumbnailCache> m_cache;
+};
@@ -0,0 +1,71 @@
+#include "LinkCheckBridge.h"
+
+#include <QApplication>
+#include <QPointer>
+
+#include <utility>
+
+LinkCheckBridge::LinkCheckBridge(QObject* parent)
+    : QObject(parent)
+    , m_checker(std::make_shared<LinkChecker>())
+{
+    m_queue.setMaxThreadCount(1);
+}
+
+void LinkCheckBridge::setProfilePath(const QString& profilePath)
+{
+    m_profilePath = profilePath;
+    m_markdown.clear();
+    m_brokenFiles.clear();
+    m_brokenPlugins.clear();
+    m_pending = false;
+    ++m_generation;
+}
+
+void LinkCheckBridge::setPluginNames(const QStringList& names)
+{
+    m_queue.start([checker = m_checker, names] { checker->setPluginNames(names); });
+    if (!m_markdown.isEmpty()) {
+        check(m_markdown);
+    }
+}
+
+void LinkCheckBridge::check(const QString& markdown)
+{
+    m_markdown = markdown;
+    if (m_checking) {
+        m_pending = true;
+        return;
+    }
+    m_checking = true;
+
+    m_queue.start([bridge = QPointer<LinkCheckBridge>(this), checker = m_checker, markdown,
+                      profilePath = m_profilePath, generation = m_generation] {
+        QStringList files;
+        QStringList plugins;
+        for (const LinkChecker::Reference& reference : checker->check(checker->extract(markdown, profilePath))) {
+            (reference.kind == LinkChecker::Reference::Kind::File ? files : plugins).append(reference.target);
+        }
+
+        QMetaObject::invokeMethod(qApp, [bridge, generation, files, plugins] {
+            if (bridge.isNull()) {
+                return;
+            }
+            bridge->m_checking = false;
+            if (generation == bridge->m_generation
+                && (files != bridge->m_brokenFiles || plugins != bridge->m_brokenPlugins)) {
+                bridge->m_brokenFiles   = files;
+                bridge->m_brokenPlugins = plugins;
+                emit bridge->checked(files, plugins);
+            }
+            if (std::exchange(bridge->m_pending, false)) {
+                bridge->check(bridge->m_markdown);
+            }
+        });
+    });
+}
+
+QVariantMap LinkCheckBridge::broken() const
+{
+    return { { "files", m_brokenFiles }, { "plugins", m_brokenPlugins } };
+}
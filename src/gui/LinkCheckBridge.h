@@ -0,0 +1,42 @@
+#pragma once
+
+#include "core/LinkChecker.h"
+
+#include <QObject>
+#include <QThreadPool>
+#include <QVariantMap>
+
+#include <memory>
+
+// Published to the preview page as "links"; tells it which references in the notes are broken
+class LinkCheckBridge final : public QObject {
+    Q_OBJECT
+
+public:
+    explicit LinkCheckBridge(QObject* parent = nullptr);
+
+    // Relative paths in the notes are resolved against the profile directory; forgets the last results
+    void setProfilePath(const QString& profilePath);
+
+    // The notes are checked again against the new names
+    void setPluginNames(const QStringList& names);
+
+    void check(const QString& markdown);
+
+    // {"files": [...], "plugins": [...]}, the broken references of the last check as written
+    Q_INVOKABLE QVariantMap broken() const;
+
+signals:
+    void checked(const QStringList& files, const QStringList& plugins);
+
+private:
+    std::shared_ptr<LinkChecker> m_checker; // only used on m_queue
+    QThreadPool m_queue;                    // single thread, as LinkChecker is not thread-safe
+    QString m_profilePath;
+    QString m_markdown; // as last asked to check
+    QStringList m_brokenFiles;
+    QStringList m_brokenPlugins;
+    int m_generation = 0; // bumped with the profile, so late results of the previous one are dropped
+    bool m_checking  = false;
+    bool m_pending   = false; // m_markdown changed while checking
+};
@@ -0,0 +1,114 @@
+#include "LogBridge.h"
+
+#include <QApplication>
+#include <QPointer>
+
+LogBridge::LogBridge(QObject* parent)
+    : QObject(parent)
+    , m_pollTimer(new QTimer(this))
+{
+    m_queue.setMaxThreadCount(1);
+    m_pollTimer->setInterval(POLL_INTERVAL);
+    connect(m_pollTimer, &QTimer::timeout, this, &LogBridge::poll);
+}
+
+void LogBridge::closeAll()
+{
+    m_logs.clear();
+    m_ids.clear();
+    m_pollTimer->stop();
+}
+
+void LogBridge::setPolling(const bool enabled)
+{
+    if (enabled == m_polling) {
+        return;
+    }
+    m_polling = enabled;
+    if (!enabled) {
+        m_pollTimer->stop();
+    } else if (!m_logs.isEmpty()) {
+        poll();
+        m_pollTimer->start();
+    }
+}
+
+int LogBridge::open(const QString& path)
+{
+    const QString resolved = LogFile::resolvePath(path, m_baseDirectory);
+    int id                 = m_ids.value(resolved);
+    if (id == 0) {
+        id = m_nextId++;
+        m_ids.insert(resolved, id);
+        m_logs.insert(id, { std::make_shared<LogFile>(resolved) });
+        if (m_polling) {
+            m_pollTimer->start();
+        }
+    }
+    refresh(id, true);
+    return id;
+}
+
+void LogBridge::refresh(const int id, const bool force)
+{
+    Log& log = m_logs[id];
+    if (log.refreshing && !force) {
+        return;
+    }
+    log.refreshing = true;
+    m_queue.start([bridge = QPointer<LogBridge>(this), file = log.file, id, force] {
+        const LogFile::Change change = file->refresh();
+        const int lineCount          = file->exists() ? file->lineCount() : -1;
+
+        QMetaObject::invokeMethod(qApp, [bridge, id, force, change, lineCount] {
+            if (bridge.isNull() || !bridge->m_logs.contains(id)) {
+                return;
+            }
+            bridge->m_logs[id].refreshing = false;
+            if (force || change != LogFile::Change::None) {
+                emit bridge->indexed(id, lineCount, change == LogFile::Change::Replaced);
+            }
+        });
+    });
+}
+
+void LogBridge::poll()
+{
+    for (const int id : m_logs.keys()) {
+        refresh(id, false);
+    }
+}
+
+void LogBridge::readLines(const int id, const int first, const int count)
+{
+    const auto it = m_logs.constFind(id);
+    if (it == m_logs.cend()) {
+        return;
+    }
+    m_queue.start([bridge = QPointer<LogBridge>(this), file = it->file, id, first, count = std::min(count, MAX_LINES)] {
+        const QStringList lines = file->lines(first, count);
+
+        QMetaObject::invokeMethod(qApp, [bridge, id, first, lines] {
+            if (!bridge.isNull() && bridge->m_logs.contains(id)) {
+                emit bridge->linesRead(id, first, lines);
+            }
+        });
+    });
+}
+
+void LogBridge::find(const int id, const QString& text, const int from, const bool backward)
+{
+    const auto it = m_logs.constFind(id);
+    if (it == m_logs.cend()) {
+        return;
+    }
+    m_queue.start([bridge = QPointer<LogBridge>(this), file = it->file, id, text, from, backward] {
+        const int line = file->find(text, from, backward);
+
+        QMetaObject::invokeMethod(qApp, [bridge, id, text, line] {
+            if (!bridge.isNull() && bridge->m_logs.contains(id)) {
+                emit bridge->found(id, text, line);
+            }
+        });
+    });
+}
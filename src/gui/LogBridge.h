@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core/LogFile.h"
+
+#include <QHash>
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <memory>
+
+// Published to the preview page as "logs"; serves the log viewers of ```logview blocks
+class LogBridge final : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int POLL_INTERVAL = 1000; // ms
+    static constexpr int MAX_LINES     = 1000; // per readLines() call
+
+    explicit LogBridge(QObject* parent = nullptr);
+
+    // Relative paths in the notes are resolved against this directory
+    void setBaseDirectory(const QString& directory) { m_baseDirectory = directory; }
+
+    // Forgets the open logs, when the page that opened them is gone
+    void closeAll();
+
+    // Stops checking the open logs for new lines while the page is not shown; they are checked right away on resume
+    void setPolling(bool enabled);
+
+    // Returns the id of the log at path, opening it if no viewer has yet. indexed() follows with its line count.
+    Q_INVOKABLE int open(const QString& path);
+
+    Q_INVOKABLE void readLines(int id, int first, int count);
+
+    // Searches from a line on, see LogFile::find(); answered by found()
+    Q_INVOKABLE void find(int id, const QString& text, int from, bool backward);
+
+signals:
+    // The log was indexed, or replaced by a new file. lineCount is -1 if the file cannot be read.
+    void indexed(int id, int lineCount, bool replaced);
+
+    void linesRead(int id, int first, const QStringList& lines);
+
+    // line is -1 if text was not found
+    void found(int id, const QString& text, int line);
+
+private:
+    struct Log {
+        std::shared_ptr<LogFile> file;
+        bool refreshing = false;
+    };
+
+    // Indexes what was appended to a log; indexed() is emitted if anything was, or always if force
+    void refresh(int id, bool force);
+    void poll();
+
+    QHash<int, Log> m_logs;
+    QHash<QString, int> m_ids; // by resolved path
+    QString m_baseDirectory;
+    QTimer* m_pollTimer;
+    bool m_polling = true;
+    QThreadPool m_queue; // single thread, as LogFile is not thread-safe
+    int m_nextId = 1;    // never reused, so answers for a closed log are not mistaken for a new one's
+};
@@ -0,0 +1,246 @@
+#include "NotesExporter.h"
+#include "NotesWidget.h"
+#include "core/AttachmentStore.h"
+
+#include <QApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointer>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QUrl>
+#include <QWebEnginePage>
+
+#include <algorithm>
+
+namespace {
+constexpr auto MANIFEST_FILE  = "export-manifest.json";
+constexpr auto EXPORT_VERSION = "1"; // bump to force a full re-export when the page template changes
+constexpr int MAX_PAGES       = 4;
+
+constexpr auto RENDER_PAGE = R"(<!DOCTYPE html>
+<html>
+<head>
+    <meta charset="utf-8">
+    <script src="qrc:/resources/marked.min.js"></script>
+    <script src="qrc:/resources/preview.js"></script>
+</head>
+<body><div id="content"></div></body>
+</html>)";
+
+constexpr auto EXPORT_PAGE = R"(<!DOCTYPE html>
+<html>
+<head>
+    <meta charset="utf-8">
+    <title>%1</title>
+    <style>
+    %2
+    </style>
+</head>
+<body>
+    <div id="content">%3</div>
+</body>
+</html>
+)";
+
+constexpr auto INDEX_FILE = "index.html";
+
+// The profile's name as it is, with only the characters no file name may hold replaced
+QString pageFileName(const QString& profileName)
+{
+    static const QRegularExpression invalidRe(R"([<>:"/\\|?*\x00-\x1f])");
+    return QString(profileName).replace(invalidRe, "_") + ".html";
+}
+
+// Links are percent-encoded; a browser decodes them back to the file name
+QString pageHref(const QString& fileName) { return QString::fromLatin1(QUrl::toPercentEncoding(fileName)); }
+
+// Copies referenced attachments next to the page and makes profile-relative images absolute
+QString localizeImages(QString html, const QString& profileDirectory, const QString& outputDirectory)
+{
+    static const QRegularExpression attachmentRe(R"(notes-img://attachments/([0-9a-f]{2}/[0-9a-f]+\.\w+))");
+    const QString storeRoot = AttachmentStore::rootForProfile(profileDirectory);
+    for (auto it = attachmentRe.globalMatch(html); it.hasNext();) {
+        const QString relative = it.next().captured(1);
+        const QString target   = outputDirectory + "/attachments/" + relative;
+        if (!QFile::exists(target)) {
+            QDir().mkpath(QFileInfo(target).absolutePath());
+            QFile::copy(storeRoot + "/" + relative, target);
+        }
+    }
+    html.replace("notes-img://attachments/", "attachments/");
+
+    static const QRegularExpression relativeImageRe(R"#(<img src="(?![a-zA-Z][a-zA-Z0-9+.-]*:|/|#))#");
+    html.replace(relativeImageRe, QString("<img src=\"%1/").arg(QUrl::fromLocalFile(profileDirectory).toString()));
+    return html;
+}
+
+}
+
+NotesExporter::NotesExporter(const QString& profilesDirectory, const QString& outputDirectory, QObject* parent)
+    : QObject(parent)
+    , m_profilesDirectory(profilesDirectory)
+    , m_outputDirectory(outputDirectory)
+{
+}
+
+void NotesExporter::start()
+{
+    QDir().mkpath(m_outputDirectory);
+
+    if (QFile file(m_outputDirectory + "/" + MANIFEST_FILE); file.open(QIODevice::ReadOnly)) {
+        const QJsonObject manifest = QJsonDocument::fromJson(file.readAll()).object();
+        for (auto it = manifest.begin(); it != manifest.end(); ++it) {
+            m_manifest.insert(it.key(), it.value().toString().toLatin1());
+        }
+    }
+
+    const QDir profilesDirectory(m_profilesDirectory);
+    for (const QFileInfo& dir : profilesDirectory.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+        if (QFile::exists(dir.absoluteFilePath("notes.md"))) {
+            m_profiles.append(dir.fileName());
+        }
+    }
+
+    if (m_profiles.isEmpty()) {
+        finish();
+        return;
+    }
+
+    // Read and hash every profile in parallel; unchanged ones never reach a renderer
+    for (const QString& name : m_profiles) {
+        const QString directory = m_profilesDirectory + "/" + name;
+        QThreadPool::globalInstance()->start([exporter = QPointer<NotesExporter>(this), name, directory] {
+            Profile profile { name, directory, {}, NotesWidget::loadPreviewStyleSheet(directory), {} };
+            if (QFile file(directory + "/notes.md"); file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                profile.markdown = QString::fromUtf8(file.readAll());
+            }
+
+            QCryptographicHash hash(QCryptographicHash::Sha1);
+            hash.addData(EXPORT_VERSION);
+            hash.addData(profile.markdown.toUtf8());
+            hash.addData(profile.styleSheet.toUtf8());
+            profile.hash = hash.result().toHex();
+
+            QMetaObject::invokeMethod(qApp, [exporter, profile] {
+                if (!exporter.isNull()) {
+                    exporter->onScanned(profile);
+                }
+            });
+        });
+    }
+}
+
+void NotesExporter::onScanned(const Profile& profile)
+{
+    if (m_manifest.value(profile.name) == profile.hash
+        && QFile::exists(m_outputDirectory + "/" + pageFileName(profile.name))) {
+        ++m_unchanged;
+        onWritten();
+        return;
+    }
+
+    m_renderQueue.enqueue(profile);
+
+    if (!m_idlePages.isEmpty()) {
+        renderNext(m_idlePages.takeFirst());
+        return;
+    }
+
+    // One renderer process per page, up to the number of cores
+    if (m_pages.size() < std::min(MAX_PAGES, QThread::idealThreadCount())) {
+        auto* const page = new QWebEnginePage(this);
+        m_pages.append(page);
+        connect(page, &QWebEnginePage::loadFinished, this, [this, page] { renderNext(page); });
+        page->setHtml(RENDER_PAGE);
+    }
+}
+
+void NotesExporter::renderNext(QWebEnginePage* page)
+{
+    if (m_renderQueue.isEmpty()) {
+        m_idlePages.append(page);
+        return;
+    }
+
+    const Profile profile = m_renderQueue.dequeue();
+
+    // A JSON array is the simplest way to get a correctly escaped JS string literal
+    const QString literal
+        = QString::fromUtf8(QJsonDocument(QJsonArray { profile.markdown }).toJson(QJsonDocument::Compact));
+    page->runJavaScript(QString("marked.parse(%1[0]);").arg(literal), [this, page, profile](const QVariant& result) {
+        onRendered(profile, result.toString());
+        renderNext(page);
+    });
+}
+
+void NotesExporter::onRendered(const Profile& profile, const QString& html)
+{
+    m_manifest.insert(profile.name, profile.hash);
+    ++m_exported;
+
+    const QString outputDirectory = m_outputDirectory;
+    QThreadPool::globalInstance()->start([exporter = QPointer<NotesExporter>(this), profile, html, outputDirectory] {
+        const QString body = localizeImages(html, profile.directory, outputDirectory);
+        QSaveFile file(outputDirectory + "/" + pageFileName(profile.name));
+        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            const QString backLink
+                = QString("<p><a href=\"%1\">&larr; %2</a></p>\n").arg(pageHref(INDEX_FILE), tr("All profiles"));
+            const QString page
+                = QString(EXPORT_PAGE).arg(profile.name.toHtmlEscaped(), profile.styleSheet, backLink + body);
+            file.write(page.toUtf8());
+            file.commit();
+        }
+
+        QMetaObject::invokeMethod(qApp, [exporter] {
+            if (!exporter.isNull()) {
+                exporter->onWritten();
+            }
+        });
+    });
+}
+
+void NotesExporter::onWritten()
+{
+    emit progress(++m_done, static_cast<int>(m_profiles.size()));
+    if (m_done == static_cast<int>(m_profiles.size())) {
+        finish();
+    }
+}
+
+void NotesExporter::finish()
+{
+    // Index of every exported profile
+    QString items;
+    for (const QString& name : m_profiles) {
+        items += QString("        <li><a href=\"%1\">%2</a></li>\n")
+                     .arg(pageHref(pageFileName(name)), name.toHtmlEscaped());
+    }
+    const QString exportedAt = tr("Exported %1").arg(QDateTime::currentDateTime().toString(Qt::ISODate));
+    const QString body
+        = QString("<h1>%1</h1>\n    <p>%2</p>\n    <ul>\n%3    </ul>").arg(tr("Profile notes"), exportedAt, items);
+    const QString index = QString(EXPORT_PAGE).arg(tr("Profile notes"), NotesWidget::loadPreviewStyleSheet({}), body);
+    if (QSaveFile file(m_outputDirectory + "/" + INDEX_FILE); file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        file.write(index.toUtf8());
+        file.commit();
+    }
+
+    QJsonObject manifest;
+    for (auto it = m_manifest.cbegin(); it != m_manifest.cend(); ++it) {
+        manifest.insert(it.key(), QString::fromLatin1(it.value()));
+    }
+    if (QSaveFile file(m_outputDirectory + "/" + MANIFEST_FILE); file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(manifest).toJson());
+        file.commit();
+    }
+
+    emit finished(m_exported, m_unchanged);
+    deleteLater();
+}
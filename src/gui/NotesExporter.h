@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QQueue>
+
+class QWebEnginePage;
+
+// Exports the notes of every profile to a static HTML site; deletes itself when done
+class NotesExporter final : public QObject {
+    Q_OBJECT
+
+public:
+    NotesExporter(const QString& profilesDirectory, const QString& outputDirectory, QObject* parent = nullptr);
+
+    void start();
+
+signals:
+    void progress(int done, int total);
+    void finished(int exported, int unchanged);
+
+private:
+    struct Profile {
+        QString name;
+        QString directory;
+        QString markdown;
+        QString styleSheet;
+        QByteArray hash;
+    };
+
+    void onScanned(const Profile& profile);
+    void onRendered(const Profile& profile, const QString& html);
+    void onWritten();
+    void renderNext(QWebEnginePage* page);
+    void finish();
+
+    QString m_profilesDirectory;
+    QString m_outputDirectory;
+    QHash<QString, QByteArray> m_manifest; // profile name -> hash of the last export
+    QStringList m_profiles;
+    QQueue<Profile> m_renderQueue;
+    QList<QWebEnginePage*> m_pages;
+    QList<QWebEnginePage*> m_idlePages;
+    int m_done      = 0;
+    int m_exported  = 0;
+    int m_unchanged = 0;
+};
@@ -0,0 +1,15 @@
+#include "NotesHighlighter.h"
+
+void NotesHighlighter::highlightBlock(const QString& text)
+{
+    if (isLongLine(currentBlock())) {
+        setCurrentBlockState(previousBlockState());
+        return;
+    }
+    if (!currentBlock().isVisible() && !text.contains(u"```") && !text.contains(u"~~~") && !text.contains(u"<!--")
+        && !text.contains(u"-->")) {
+        setCurrentBlockState(previousBlockState());
+        return;
+    }
+    MarkdownHighlighter::highlightBlock(text);
+}
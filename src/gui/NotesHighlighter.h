@@ -0,0 +1,23 @@
+#pragma once
+
+#include "markdownhighlighter.h"
+#include <QTextBlock>
+
+// Markdown highlighter that skips folded blocks and lines longer than LONG_LINE
+class NotesHighlighter final : public MarkdownHighlighter {
+    Q_OBJECT
+
+public:
+    static constexpr int LONG_LINE = 10000; // characters
+
+    // Whether a block's text, without its separator, is longer than LONG_LINE
+    [[nodiscard]] static bool isLongLine(const QTextBlock& block)
+    {
+        return block.isValid() && block.length() - 1 > LONG_LINE;
+    }
+
+    using MarkdownHighlighter::MarkdownHighlighter;
+
+protected:
+    void highlightBlock(const QString& text) override;
+};
@@ -0,0 +1,715 @@
+#include "NotesTextEdit.h"
+#include "NotesHighlighter.h"
+
+#include <QApplication>
+#include <QContextMenuEvent>
+#include <QDebug>
+#include <QDropEvent>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QInputMethodEvent>
+#include <QKeyEvent>
+#include <QLocale>
+#include <QMenu>
+#include <QMimeData>
+#include <QPainter>
+#include <QPointer>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QThreadPool>
+
+#include <algorithm>
+
+NotesTextEdit::NotesTextEdit(QWidget* parent)
+    : QMarkdownTextEdit(parent, false)
+{
+    _highlighter = new NotesHighlighter(document());
+
+    // Changes are recorded in m_undoLog instead
+    document()->setUndoRedoEnabled(false);
+    connect(document(), &QTextDocument::contentsChange, this, &NotesTextEdit::onContentsChange);
+
+    connect(this, &QPlainTextEdit::cursorPositionChanged, this, [this] {
+        // Never leave the cursor in folded text
+        const QTextBlock block = textCursor().block();
+        if (!block.isVisible()) {
+            revealBlock(block);
+        }
+
+        // A long line is laid out in full only while the cursor is in it
+        if (block != m_expandedBlock) {
+            relayoutLongLine(m_expandedBlock);
+            m_expandedBlock = NotesHighlighter::isLongLine(block) ? block : QTextBlock();
+            relayoutLongLine(m_expandedBlock);
+        }
+    });
+}
+
+void NotesTextEdit::loadText(const QString& text, const QString& undoLogPath, const QList<Fold>& folds)
+{
+    // The highlighter is detached while the text is replaced, so it first sees the text with the folds in place
+    m_recording = false;
+    highlighter()->setDocument(nullptr);
+    setPlainText(text);
+
+    m_hasFolds    = false;
+    int dirtyFrom = -1;
+    int dirtyTo   = -1;
+    for (const Fold& fold : folds) {
+        const QTextBlock opener = document()->findBlockByNumber(fold.first - 1);
+        const QTextBlock last   = document()->findBlockByNumber(fold.end - 1);
+        if (fold.first < 0 || fold.first >= fold.end || !last.isValid() || opener.text() != fold.opener) {
+            continue; // the text was changed outside the editor
+        }
+        hideBlocks(fold.first, fold.end);
+        const int from = document()->findBlockByNumber(fold.first).position();
+        dirtyFrom      = dirtyFrom < 0 ? from : std::min(dirtyFrom, from);
+        dirtyTo        = std::max(dirtyTo, last.position() + last.length());
+    }
+    if (dirtyFrom >= 0) {
+        document()->markContentsDirty(dirtyFrom, dirtyTo - dirtyFrom);
+    }
+
+    highlighter()->setDocument(document());
+    m_recording = true;
+
+    m_length   = document()->characterCount() - 1;
+    m_snapshot = {};
+    ++m_textRevision;
+    m_undoLog.clear();
+    m_undoLogLoaded = false;
+
+    // Reading and decompressing a history of several MB is left to a worker
+    QThreadPool::globalInstance()->start([edit = QPointer<NotesTextEdit>(this), undoLogPath, text = rawText(),
+                                             generation = ++m_undoLogGeneration] {
+        const std::optional<UndoLog> saved = UndoLog::load(undoLogPath, text);
+
+        QMetaObject::invokeMethod(qApp, [edit, generation, saved] {
+            if (edit.isNull() || generation != edit->m_undoLogGeneration) {
+                return;
+            }
+            // The saved steps lead up to the text as it was loaded, so they go underneath anything recorded since
+            edit->m_undoLogLoaded = true;
+            if (saved.has_value()) {
+                edit->m_undoLog.prepend(*saved);
+            }
+            emit edit->undoLogLoaded();
+        });
+    });
+}
+
+void NotesTextEdit::setUndoMemoryBudget(const qsizetype bytes) { m_undoLog.setMemoryBudget(bytes); }
+
+void NotesTextEdit::setBlocksFolded(const int first, const int end, const bool folded)
+{
+    QTextBlock block = document()->findBlockByNumber(first);
+    if (!block.isValid() || first >= end) {
+        return;
+    }
+
+    if (folded) {
+        // Move the cursor out of the text about to be hidden
+        if (const int cursorBlock = textCursor().blockNumber(); cursorBlock >= first && cursorBlock < end) {
+            QTextCursor cursor(block.previous().isValid() ? block.previous() : block);
+            cursor.movePosition(QTextCursor::EndOfBlock);
+            setTextCursor(cursor);
+        }
+    }
+
+    const int start = block.position();
+    int length      = 0;
+    QList<QTextBlock> shown;
+    for (int number = first; block.isValid() && number < end; block = block.next(), ++number) {
+        if (!folded && !block.isVisible()) {
+            shown.append(block);
+        }
+        block.setVisible(!folded);
+        block.setLineCount(folded ? 0 : std::max(1, block.layout()->lineCount()));
+        length += block.length();
+    }
+
+    // Let the layout recompute the block heights and the scroll range
+    document()->markContentsDirty(start, length);
+    viewport()->update();
+
+    // The highlighter skipped these while they were hidden
+    for (const QTextBlock& shownBlock : shown) {
+        highlighter()->rehighlightBlock(shownBlock);
+    }
+
+    m_hasFolds |= folded;
+    emit foldsChanged();
+}
+
+void NotesTextEdit::hideBlocks(const int first, const int end)
+{
+    QTextBlock block = document()->findBlockByNumber(first);
+    for (int number = first; block.isValid() && number < end; block = block.next(), ++number) {
+        block.setVisible(false);
+        block.setLineCount(0);
+    }
+    m_hasFolds = true;
+}
+
+QList<NotesTextEdit::Fold> NotesTextEdit::folds()
+{
+    QList<Fold> folds;
+    if (!m_hasFolds) {
+        return folds;
+    }
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+        if (block.isVisible()) {
+            continue;
+        }
+        Fold fold;
+        fold.first  = block.blockNumber();
+        fold.opener = block.previous().text();
+        while (block.next().isValid() && !block.next().isVisible()) {
+            block = block.next();
+        }
+        fold.end = block.blockNumber() + 1;
+        folds.append(fold);
+    }
+    m_hasFolds = !folds.isEmpty();
+    return folds;
+}
+
+void NotesTextEdit::revealBlock(const QTextBlock& block)
+{
+    if (!block.isValid() || block.isVisible()) {
+        return;
+    }
+    QTextBlock first = block;
+    while (first.previous().isValid() && !first.previous().isVisible()) {
+        first = first.previous();
+    }
+    QTextBlock last = block;
+    while (last.next().isValid() && !last.next().isVisible()) {
+        last = last.next();
+    }
+    setBlocksFolded(first.blockNumber(), last.blockNumber() + 1, false);
+}
+
+QString NotesTextEdit::textRange(const qsizetype position, const qsizetype length) const
+{
+    // Raw document text, with U+2029 between blocks
+    QTextCursor cursor(document());
+    cursor.setPosition(static_cast<int>(position));
+    cursor.setPosition(static_cast<int>(position + length), QTextCursor::KeepAnchor);
+    return cursor.selectedText();
+}
+
+void NotesTextEdit::takeSnapshot(const int from, const int to)
+{
+    // Whole blocks, and the ones before and after, which deleting a block separator joins in
+    QTextBlock first = document()->findBlock(from);
+    QTextBlock last  = document()->findBlock(to);
+    if (first.previous().isValid()) {
+        first = first.previous();
+    }
+    if (last.next().isValid()) {
+        last = last.next();
+    }
+    const qsizetype end = std::min<qsizetype>(last.position() + last.length(), m_length);
+    m_snapshot          = { first.position(), textRange(first.position(), end - first.position()) };
+}
+
+void NotesTextEdit::takeCursorSnapshot()
+{
+    const QTextCursor cursor = textCursor();
+    takeSnapshot(cursor.selectionStart(), cursor.selectionEnd());
+}
+
+void NotesTextEdit::onContentsChange(const int position, const int charsRemoved, const int charsAdded)
+{
+    Q_UNUSED(charsRemoved)
+
+    // The expanded line may have been removed, joined to another or cut short. It is only looked at when it is
+    // still the cursor's block, as a handle to a removed block is stale.
+    if (m_expandedBlock != textCursor().block() || !NotesHighlighter::isLongLine(m_expandedBlock)) {
+        m_expandedBlock = QTextBlock();
+    }
+
+    if (!m_recording) {
+        return;
+    }
+
+    // The reported counts can include the document's final block separator, so the removed length is
+    // derived from the change in document length instead
+    const qsizetype length  = document()->characterCount() - 1;
+    const qsizetype added   = std::clamp<qsizetype>(charsAdded, 0, std::max<qsizetype>(length - position, 0));
+    const qsizetype removed = m_length - (length - added);
+    const qsizetype offset  = position - m_snapshot.position;
+    const bool inSnapshot   = m_snapshot.position >= 0 && offset >= 0 && offset + removed <= m_snapshot.text.size();
+    const bool covered      = removed == 0 || inSnapshot;
+    if (!covered && removed == added && removed > 0) {
+        return; // only formats changed, e.g. by the highlighter
+    }
+    m_length = length;
+    if (position < 0 || removed < 0 || !covered) {
+        // Out of step with the document, or the removed text is unknown; start over rather than record a wrong step
+        qWarning() << "Undo history out of sync with the document, discarding it";
+        m_snapshot = {};
+        ++m_textRevision;
+        m_undoLog.clear();
+        m_undoLogLoaded = true;
+        ++m_undoLogGeneration;
+        return;
+    }
+
+    const QString removedText  = removed > 0 ? m_snapshot.text.mid(offset, removed) : QString();
+    const QString insertedText = textRange(position, added);
+    if (removedText == insertedText) {
+        return; // only formats changed
+    }
+    ++m_textRevision;
+    if (!m_applying) {
+        m_undoLog.record(position, removedText, insertedText);
+    }
+
+    // Keep the snapshot in step, for the changes that follow within the same input event
+    if (m_snapshot.position < 0) {
+        return;
+    }
+    if (position + removed <= m_snapshot.position) {
+        m_snapshot.position += added - removed;
+    } else if (inSnapshot) {
+        m_snapshot.text.replace(offset, removed, insertedText);
+    }
+}
+
+bool NotesTextEdit::applyStep(const UndoLog::Step& step, const bool undo)
+{
+    // Check the whole step against the current text before touching the document. Nothing before the first
+    // position the step edits changes, so only the text from there on is read.
+    qsizetype start = m_length;
+    for (const UndoLog::Edit& edit : step.edits) {
+        start = std::min(start, edit.position);
+    }
+    if (start < 0) {
+        return false;
+    }
+    const QString before = textRange(start, m_length - start);
+    QString text         = before;
+    for (qsizetype i = 0; i < step.edits.size(); ++i) {
+        const UndoLog::Edit& edit = step.edits[undo ? step.edits.size() - 1 - i : i];
+        const QString& from       = undo ? edit.inserted : edit.removed;
+        const QString& to         = undo ? edit.removed : edit.inserted;
+        const qsizetype position  = edit.position - start;
+        if (position + from.size() > text.size() || QStringView(text).mid(position, from.size()) != from) {
+            return false;
+        }
+        text.replace(position, from.size(), to);
+    }
+
+    m_snapshot = { start, before };
+    m_applying = true;
+    QTextCursor cursor(document());
+    cursor.beginEditBlock();
+    for (qsizetype i = 0; i < step.edits.size(); ++i) {
+        const UndoLog::Edit& edit = step.edits[undo ? step.edits.size() - 1 - i : i];
+        const QString& from       = undo ? edit.inserted : edit.removed;
+        cursor.setPosition(static_cast<int>(edit.position));
+        cursor.setPosition(static_cast<int>(edit.position + from.size()), QTextCursor::KeepAnchor);
+        cursor.insertText(undo ? edit.removed : edit.inserted);
+    }
+    cursor.endEditBlock();
+    m_applying = false;
+    m_snapshot = {};
+
+    setTextCursor(cursor);
+    ensureCursorVisible();
+    return true;
+}
+
+void NotesTextEdit::editAsStep(QTextCursor& cursor, const std::function<void()>& edit)
+{
+    // A command may change the text anywhere, which is rare enough to read all of it first
+    m_undoLog.closeStep();
+    m_snapshot = { 0, rawText() };
+    cursor.beginEditBlock();
+    edit();
+    cursor.endEditBlock();
+    m_snapshot = {};
+    m_undoLog.closeStep();
+}
+
+void NotesTextEdit::replaceRange(const int position, const int length, const QString& text)
+{
+    QTextCursor cursor(document());
+    editAsStep(cursor, [&] {
+        cursor.setPosition(position);
+        cursor.setPosition(position + length, QTextCursor::KeepAnchor);
+        cursor.insertText(text);
+    });
+}
+
+void NotesTextEdit::replaceLines(const int first, const QStringList& lines)
+{
+    QTextCursor cursor(document());
+    editAsStep(cursor, [&] {
+        QTextBlock block = document()->findBlockByNumber(first);
+        for (const QString& line : lines) {
+            if (!block.isValid()) {
+                break;
+            }
+
+            // Only the part that differs is replaced, so positions in the rest of the line stay put
+            const QString text = block.text();
+            qsizetype head     = 0;
+            while (head < text.size() && head < line.size() && text[head] == line[head]) {
+                ++head;
+            }
+            qsizetype tail = 0;
+            while (tail < text.size() - head && tail < line.size() - head
+                && text[text.size() - 1 - tail] == line[line.size() - 1 - tail]) {
+                ++tail;
+            }
+            if (head + tail < text.size() || head + tail < line.size()) {
+                cursor.setPosition(block.position() + static_cast<int>(head));
+                cursor.setPosition(block.position() + static_cast<int>(text.size() - tail), QTextCursor::KeepAnchor);
+                cursor.insertText(line.mid(head, line.size() - head - tail));
+            }
+            block = block.next();
+        }
+    });
+}
+
+void NotesTextEdit::undoEdit()
+{
+    // Until the saved history is read, only the steps recorded since loading can be undone
+    if (const auto step = m_undoLog.takeUndo(); step.has_value() && !applyStep(*step, true)) {
+        qWarning() << "Undo history does not match the document, discarding it";
+        m_undoLog.clear();
+    }
+}
+
+void NotesTextEdit::redoEdit()
+{
+    if (const auto step = m_undoLog.takeRedo(); step.has_value() && !applyStep(*step, false)) {
+        qWarning() << "Undo history does not match the document, discarding it";
+        m_undoLog.clear();
+    }
+}
+
+void NotesTextEdit::elideLongLine(QTextBlock block) const
+{
+    // One line with the start of the text; only that part is shaped
+    QTextLayout* const layout = block.layout();
+    QTextOption option        = document()->defaultTextOption();
+    option.setWrapMode(QTextOption::NoWrap);
+    layout->setTextOption(option);
+    layout->beginLayout();
+    QTextLine line = layout->createLine();
+    line.setLeadingIncluded(true);
+    line.setNumColumns(ELIDED_LENGTH);
+    line.setPosition(QPointF(document()->documentMargin(), 0));
+    layout->endLayout();
+    block.setLineCount(1);
+}
+
+void NotesTextEdit::relayoutLongLine(QTextBlock block)
+{
+    if (!NotesHighlighter::isLongLine(block)) {
+        return;
+    }
+    block.clearLayout();
+
+    // A change within a single block is laid out again right away, which is what eliding avoids; one that reaches
+    // into a neighbour only drops the layouts, and the next paint decides how the line is shown
+    QTextBlock neighbour = block.next().isValid() ? block.next() : block.previous();
+    if (!neighbour.isValid()) {
+        neighbour = block;
+    }
+    const int from = std::min(block.position(), neighbour.position());
+    const int to   = std::max(block.position() + block.length(), neighbour.position() + 1);
+    document()->markContentsDirty(from, to - from);
+    viewport()->update();
+}
+
+void NotesTextEdit::paintEvent(QPaintEvent* event)
+{
+    // Lay out the long lines in view as one elided line each, before the base class lays them out in full
+    const QPointF offset = contentOffset();
+    QList<QTextBlock> elided;
+    for (QTextBlock block = firstVisibleBlock(); block.isValid(); block = block.next()) {
+        if (!block.isVisible()) {
+            continue;
+        }
+        if (NotesHighlighter::isLongLine(block) && block != m_expandedBlock) {
+            if (block.layout()->lineCount() == 0) {
+                elideLongLine(block);
+            }
+            elided.append(block);
+        }
+        if (blockBoundingGeometry(block).translated(offset).top() > viewport()->height()) {
+            break;
+        }
+    }
+
+    QMarkdownTextEdit::paintEvent(event);
+
+    // Each elided line ends in a control that shows it in full
+    m_expandControls.clear();
+    if (elided.isEmpty()) {
+        return;
+    }
+    QPainter painter(viewport());
+    const QFontMetricsF metrics(font());
+    for (const QTextBlock& block : elided) {
+        const QTextLine line = block.layout()->lineAt(0);
+        if (!line.isValid() || line.textLength() >= block.length() - 1) {
+            continue;
+        }
+        const int hidden      = block.length() - 1 - line.textLength();
+        const QString label   = tr("… %1 more characters").arg(QLocale().toString(hidden));
+        const qreal spacing   = metrics.averageCharWidth();
+        const QPointF topLeft = blockBoundingGeometry(block).translated(offset).topLeft()
+            + QPointF(line.x() + line.naturalTextWidth() + spacing, line.y());
+        const QRectF rect(topLeft, QSizeF(metrics.horizontalAdvance(label) + spacing, line.height()));
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(palette().color(QPalette::AlternateBase));
+        painter.drawRoundedRect(rect, 3, 3);
+        painter.setPen(palette().color(QPalette::PlaceholderText));
+        painter.drawText(rect, Qt::AlignCenter, label);
+        m_expandControls.append({ rect, block.position() + line.textLength() });
+    }
+}
+
+void NotesTextEdit::mousePressEvent(QMouseEvent* event)
+{
+    // Dragging the selection out of the editor removes it
+    takeCursorSnapshot();
+
+    if (event->button() == Qt::LeftButton) {
+        for (const auto& [rect, position] : m_expandControls) {
+            if (rect.contains(event->position())) {
+                QTextCursor cursor(document());
+                cursor.setPosition(position);
+                setTextCursor(cursor);
+                event->accept();
+                return;
+            }
+        }
+    }
+    QMarkdownTextEdit::mousePressEvent(event);
+}
+
+void NotesTextEdit::keyPressEvent(QKeyEvent* event)
+{
+    // While completions are shown, the popup acts on these
+    if (m_completer != nullptr && m_completer->popup()->isVisible()) {
+        switch (event->key()) {
+        case Qt::Key_Enter:
+        case Qt::Key_Return:
+        case Qt::Key_Escape:
+        case Qt::Key_Tab:
+        case Qt::Key_Backtab:
+            event->ignore();
+            return;
+        default:
+            break;
+        }
+    }
+
+    if (event->matches(QKeySequence::Undo)) {
+        undoEdit();
+        event->accept();
+        return;
+    }
+    if (event->matches(QKeySequence::Redo)) {
+        redoEdit();
+        event->accept();
+        return;
+    }
+    // Again, as keys typed while completions are shown are sent here without passing the event filter
+    takeCursorSnapshot();
+    QMarkdownTextEdit::keyPressEvent(event);
+
+    if (m_completer == nullptr) {
+        return;
+    }
+    const bool typed = !event->text().isEmpty() && event->text().front().isPrint()
+        && !event->modifiers().testAnyFlags(Qt::ControlModifier | Qt::AltModifier);
+    if (typed || (event->key() == Qt::Key_Backspace && m_completer->popup()->isVisible())) {
+        updateCompletion();
+    } else if (event->key() != Qt::Key_Shift && event->key() != Qt::Key_Control && event->key() != Qt::Key_Alt) {
+        m_completer->popup()->hide();
+    }
+}
+
+void NotesTextEdit::setCompletionIndex(const CompletionIndex* index)
+{
+    m_completionIndex = index;
+    if (index == nullptr || m_completer != nullptr) {
+        return;
+    }
+    m_completionModel = new QStringListModel(this);
+    m_completer       = new QCompleter(m_completionModel, this);
+    m_completer->setWidget(this);
+    m_completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion); // the index did the filtering
+    m_completer->setCaseSensitivity(Qt::CaseInsensitive);
+    connect(m_completer, qOverload<const QString&>(&QCompleter::activated), this, &NotesTextEdit::insertCompletion);
+}
+
+void NotesTextEdit::updateCompletion()
+{
+    QAbstractItemView* const popup = m_completer->popup();
+    const QTextCursor cursor       = textCursor();
+    const QString line             = cursor.block().text().left(cursor.positionInBlock());
+    const QString rest             = cursor.block().text().mid(cursor.positionInBlock());
+    if (m_completionIndex == nullptr || cursor.hasSelection() || (!rest.isEmpty() && rest.front().isLetterOrNumber())) {
+        popup->hide();
+        return;
+    }
+
+    // Word starts the name could begin at, nearest first. Names have spaces, so this goes back a few words,
+    // but not past markdown punctuation.
+    static const QString boundaries = QStringLiteral("`[]()|,;:*\"\t");
+    QList<qsizetype> starts;
+    for (qsizetype i = line.size() - 1; i >= 0 && starts.size() < MAX_COMPLETION_WORDS; --i) {
+        if (boundaries.contains(line[i])) {
+            break;
+        }
+        if (line[i].isLetterOrNumber() && (i == 0 || !line[i - 1].isLetterOrNumber())) {
+            starts.append(i);
+        }
+    }
+
+    // The longest prefix that matches anything wins
+    for (auto it = starts.crbegin(); it != starts.crend(); ++it) {
+        const QString prefix = line.mid(*it);
+        if (prefix.size() < MIN_COMPLETION) {
+            break;
+        }
+        const QList<CompletionIndex::Completion> completions = m_completionIndex->complete(prefix, MAX_COMPLETIONS);
+        if (completions.isEmpty()
+            || (completions.size() == 1 && completions.front().name.compare(prefix, Qt::CaseInsensitive) == 0)) {
+            continue;
+        }
+
+        QStringList names;
+        for (const CompletionIndex::Completion& completion : completions) {
+            names.append(completion.name);
+        }
+        m_completionModel->setStringList(names);
+        m_completionStart = cursor.block().position() + static_cast<int>(*it);
+
+        QTextCursor start(document());
+        start.setPosition(m_completionStart);
+        QRect rect = cursorRect(start);
+        rect.setWidth(popup->sizeHintForColumn(0) + popup->verticalScrollBar()->sizeHint().width());
+        m_completer->complete(rect);
+        popup->setCurrentIndex(m_completer->completionModel()->index(0, 0));
+        return;
+    }
+    popup->hide();
+}
+
+void NotesTextEdit::insertCompletion(const QString& name)
+{
+    QTextCursor cursor = textCursor();
+    if (m_completionStart < cursor.block().position() || m_completionStart > cursor.position()) {
+        return;
+    }
+    cursor.setPosition(m_completionStart, QTextCursor::KeepAnchor);
+    takeCursorSnapshot();
+    cursor.insertText(name);
+    setTextCursor(cursor);
+}
+
+bool NotesTextEdit::eventFilter(QObject* watched, QEvent* event)
+{
+    // QMarkdownTextEdit edits in its event filter as well as in keyPressEvent(), both after this
+    if (watched == this && event->type() == QEvent::KeyPress) {
+        takeCursorSnapshot();
+    }
+
+    // QMarkdownTextEdit opens its own search widget for these; NotesWidget shows its find bar instead
+    if (watched == this && event->type() == QEvent::KeyPress) {
+        const auto* keyEvent = static_cast<QKeyEvent*>(event);
+        const bool replace   = keyEvent->matches(QKeySequence::Replace)
+            || (keyEvent->key() == Qt::Key_R && keyEvent->modifiers() == Qt::ControlModifier);
+        if (replace || keyEvent->matches(QKeySequence::Find)) {
+            emit findRequested(replace);
+            return true;
+        }
+        if (keyEvent->matches(QKeySequence::FindNext) || keyEvent->matches(QKeySequence::FindPrevious)) {
+            emit findNextRequested(keyEvent->matches(QKeySequence::FindPrevious));
+            return true;
+        }
+    }
+    return QMarkdownTextEdit::eventFilter(watched, event);
+}
+
+void NotesTextEdit::contextMenuEvent(QContextMenuEvent* event)
+{
+    // Point the standard Undo/Redo entries at the undo log
+    QMenu* menu = createStandardContextMenu(event->pos());
+    takeCursorSnapshot(); // for Cut, Paste and Delete
+    for (QAction* action : menu->actions()) {
+        if (action->objectName() == "edit-undo" || action->objectName() == "edit-redo") {
+            const bool isUndo = action->objectName() == "edit-undo";
+            action->disconnect();
+            action->setEnabled(!m_undoLogLoaded || (isUndo ? m_undoLog.canUndo() : m_undoLog.canRedo()));
+            connect(action, &QAction::triggered, this, isUndo ? &NotesTextEdit::undoEdit : &NotesTextEdit::redoEdit);
+        }
+    }
+    emit contextMenuRequested(menu, cursorForPosition(event->pos()));
+    menu->exec(event->globalPos());
+    delete menu;
+}
+
+void NotesTextEdit::inputMethodEvent(QInputMethodEvent* event)
+{
+    takeCursorSnapshot();
+    QMarkdownTextEdit::inputMethodEvent(event);
+}
+
+void NotesTextEdit::dropEvent(QDropEvent* event)
+{
+    // Moving text within the editor removes the selection and inserts at the drop point in one edit
+    const QTextCursor cursor = textCursor();
+    const int target         = cursorForPosition(event->position().toPoint()).position();
+    takeSnapshot(std::min(cursor.selectionStart(), target), std::max(cursor.selectionEnd(), target));
+    QMarkdownTextEdit::dropEvent(event);
+}
+
+QStringList NotesTextEdit::imageFiles(const QMimeData* source)
+{
+    QStringList files;
+    if (!source->hasUrls()) {
+        return files;
+    }
+
+    const QList<QByteArray> formats = QImageReader::supportedImageFormats();
+    for (const QUrl& url : source->urls()) {
+        if (url.isLocalFile() && formats.contains(QFileInfo(url.toLocalFile()).suffix().toLower().toLatin1())) {
+            files.append(url.toLocalFile());
+        }
+    }
+    return files;
+}
+
+bool NotesTextEdit::canInsertFromMimeData(const QMimeData* source) const
+{
+    return source->hasImage() || !imageFiles(source).isEmpty() || QMarkdownTextEdit::canInsertFromMimeData(source);
+}
+
+void NotesTextEdit::insertFromMimeData(const QMimeData* source)
+{
+    // Prefer the original files so their encoding is kept
+    if (const QStringList files = imageFiles(source); !files.isEmpty()) {
+        emit imageFilesPasted(files);
+        return;
+    }
+
+    if (source->hasImage()) {
+        if (const auto image = qvariant_cast<QImage>(source->imageData()); !image.isNull()) {
+            emit imagePasted(image);
+            return;
+        }
+    }
+
+    QMarkdownTextEdit::insertFromMimeData(source);
+}
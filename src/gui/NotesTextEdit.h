@@ -0,0 +1,145 @@
+#pragma once
+
+#include "core/CompletionIndex.h"
+#include "core/UndoLog.h"
+#include "qmarkdowntextedit.h"
+
+#include <QCompleter>
+#include <QImage>
+#include <QMenu>
+#include <QStringListModel>
+
+#include <functional>
+
+// The notes editor: QMarkdownTextEdit with an UndoLog, long line eliding and name completion
+class NotesTextEdit final : public QMarkdownTextEdit {
+    Q_OBJECT
+
+public:
+    struct Fold {
+        int first = 0;  // first hidden block
+        int end   = 0;  // one past the last
+        QString opener; // text of the block before first, which stays visible
+    };
+
+    explicit NotesTextEdit(QWidget* parent = nullptr);
+
+    // Replaces the text and starts a new undo history. The history saved at undoLogPath for this text is
+    // read on a worker and put underneath whatever was recorded meanwhile. Folds whose opener still matches
+    // the text are hidden before the text is laid out or highlighted.
+    void loadText(const QString& text, const QString& undoLogPath, const QList<Fold>& folds = {});
+
+    void setUndoMemoryBudget(qsizetype bytes);
+
+    // The undo history, for saving together with rawText(); complete once isUndoLogLoaded()
+    [[nodiscard]] const UndoLog& undoLog() const { return m_undoLog; }
+
+    [[nodiscard]] bool isUndoLogLoaded() const { return m_undoLogLoaded; }
+
+    // The document text as the undo history counts it, with U+2029 between blocks; copied out on every call
+    [[nodiscard]] QString rawText() const { return textRange(0, m_length); }
+
+    // Increases with every change to the text. QTextDocument::revision() cannot be used with its undo stack off.
+    [[nodiscard]] quint64 textRevision() const { return m_textRevision; }
+
+    // Runs edit, which changes the text through cursor, as one edit block and one undo step of its own, so
+    // text inserted by commands never merges into the typing around it. Edits to the text that do not come
+    // from input events must go through here.
+    void editAsStep(QTextCursor& cursor, const std::function<void()>& edit);
+
+    // Replaces a range of the text as one edit and one undo step of its own
+    void replaceRange(int position, int length, const QString& text);
+
+    // Replaces the text of the blocks from first on, one per line, as one edit and one undo step of its own
+    void replaceLines(int first, const QStringList& lines);
+
+    // Hides or shows the blocks first..end-1; hidden blocks take no space in the layout
+    void setBlocksFolded(int first, int end, bool folded);
+
+    // Shows the run of hidden blocks around a block
+    void revealBlock(const QTextBlock& block);
+
+    // The runs of hidden blocks
+    [[nodiscard]] QList<Fold> folds();
+
+    // Offers names from index while typing. The index is looked up on every keystroke and must outlive the editor.
+    void setCompletionIndex(const CompletionIndex* index);
+
+public slots:
+    void undoEdit();
+    void redoEdit();
+
+signals:
+    // Image data was pasted or dropped; the text cursor is at the insertion point
+    void imagePasted(const QImage& image);
+
+    // Local image files were pasted or dropped; the text cursor is at the insertion point
+    void imageFilesPasted(const QStringList& filePaths);
+
+    // Find (or replace) was requested from the keyboard
+    void findRequested(bool replace);
+
+    // Find next or previous (F3, Shift+F3) was requested from the keyboard
+    void findNextRequested(bool backward);
+
+    // The saved undo history was read and put underneath the recorded steps
+    void undoLogLoaded();
+
+    // Blocks were folded or unfolded
+    void foldsChanged();
+
+    // The context menu is about to be shown for the text at cursor; connect directly to add entries
+    void contextMenuRequested(QMenu* menu, const QTextCursor& cursor);
+
+protected:
+    [[nodiscard]] bool canInsertFromMimeData(const QMimeData* source) const override;
+    void insertFromMimeData(const QMimeData* source) override;
+    void keyPressEvent(QKeyEvent* event) override;
+    void inputMethodEvent(QInputMethodEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void dropEvent(QDropEvent* event) override;
+    void paintEvent(QPaintEvent* event) override;
+    void contextMenuEvent(QContextMenuEvent* event) override;
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    static QStringList imageFiles(const QMimeData* source);
+    [[nodiscard]] QString textRange(qsizetype position, qsizetype length) const;
+    // Keeps the text of the blocks from..to touch, and of their neighbours, for the next changes to take what
+    // they removed from
+    void takeSnapshot(int from, int to);
+    void takeCursorSnapshot();
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    bool applyStep(const UndoLog::Step& step, bool undo);
+    void hideBlocks(int first, int end);
+    void elideLongLine(QTextBlock block) const;
+    void relayoutLongLine(QTextBlock block);
+    void updateCompletion();
+    void insertCompletion(const QString& name);
+
+    static constexpr int ELIDED_LENGTH        = 200; // characters of a long line shown while it is elided
+    static constexpr int MIN_COMPLETION       = 3;   // characters typed before names are offered
+    static constexpr int MAX_COMPLETIONS      = 12;
+    static constexpr int MAX_COMPLETION_WORDS = 6; // how many words back a name may start
+
+    struct Snapshot {
+        qsizetype position = -1; // -1 if there is none
+        QString text;
+    };
+
+    UndoLog m_undoLog;
+    Snapshot m_snapshot; // text around where the next change may remove some, taken before it
+    qsizetype m_length = 0; // characters in the document, without its final block separator
+    QTextBlock m_expandedBlock;                     // long line the cursor is in, laid out in full
+    QList<std::pair<QRectF, int>> m_expandControls; // painted expand controls and where they put the cursor
+    const CompletionIndex* m_completionIndex = nullptr;
+    QCompleter* m_completer                  = nullptr;
+    QStringListModel* m_completionModel      = nullptr;
+    int m_completionStart                    = -1; // position of the text the shown completions replace
+    quint64 m_textRevision  = 0;
+    int m_undoLogGeneration = 0; // bumped with every new history, so a late read of the saved one is dropped
+    bool m_undoLogLoaded    = true;
+    bool m_recording        = true;  // false while the document is replaced
+    bool m_applying         = false; // true while an undo or redo step is applied
+    bool m_hasFolds         = false; // whether any block may be hidden
+};
@@ -1,19 +1,37 @@
 #include "NotesWidget.h"
 
 #include "DefaultContent.h"
+#include "HistoryDialog.h"
+#include "NotesExporter.h"
+#include "QuickOpenDialog.h"
+#include "TasksDialog.h"
+#include "core/AttachmentStore.h"
+#include "core/PreviewCache.h"
 
 #include <QApplication>
 #include <QDebug>
 #include <QDir>
+#include <QFileDialog>
 
 #include "NotesWebPage.h"
+#include <QAbstractTextDocumentLayout>
 #include <QHBoxLayout>
 #include <QInputDialog>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QMenu>
 #include <QMessageBox>
+#include <QPointer>
+#include <QProgressDialog>
+#include <QRegularExpression>
+#include <QScreen>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QThreadPool>
 #include <QToolButton>
+#include <QUrl>
+#include <QWebChannel>
 #include <QWebEngineProfile>
 #include <QWebEngineScript>
 #include <QWebEngineSettings>
@@ -21,6 +39,9 @@
 
 #include <qstyle.h>
 
+#include <algorithm>
+#include <utility>
+
 namespace {
 // Gruvbox muted colors
 constexpr auto BASE01_DARKER_BG = "#32302f"; // Darker muted background
@@ -32,29 +53,68 @@ constexpr auto BASE0D_BLUE      = "#458588"; // Muted blue
 constexpr auto BASE0E_PURPLE    = "#b16286"; // Muted purple
 constexpr auto BASE0C_AQUA      = "#689d6a"; // Muted aqua
 constexpr auto FONT_MONO        = "monospace"; // Monospace font
+
+// setHtml() navigates to a data: URL of the percent-encoded page, and longer URLs fail to load
+constexpr qsizetype MAX_DATA_URL_BYTES = 2 * 1024 * 1024;
+
+// Whether setHtml() can load the page. Encoding triples most bytes of markup, so the size is measured.
+bool fitsDataUrl(const QString& html)
+{
+    static const QByteArray prefix = QByteArrayLiteral("data:text/html;charset=UTF-8,");
+    return html.size() < MAX_DATA_URL_BYTES
+        && prefix.size() + QUrl::toPercentEncoding(html).size() < MAX_DATA_URL_BYTES;
+}
+
+constexpr int INDENT_WIDTH = 4; // spaces added by Indent, enough to nest a list item
+
+// The undo history is rewritten whole, so it is saved at most this often (ms) rather than with every auto-save
+constexpr int UNDO_SAVE_INTERVAL = 60 * 1000;
 }
 
 NotesWidget::NotesWidget(QWidget* parent)
     : QWidget(parent)
-    , m_stackedWidget(new QStackedWidget(this))
-    , m_textEdit(new QMarkdownTextEdit(this))
+    , m_outlineSplitter(new QSplitter(Qt::Horizontal, this))
+    , m_splitter(new QSplitter(Qt::Horizontal, this))
+    , m_outlinePanel(new OutlinePanel(this))
+    , m_textEdit(new NotesTextEdit(this))
     , m_webView(new QWebEngineView(this))
+    , m_previewBridge(new PreviewBridge(this))
+    , m_logBridge(new LogBridge(this))
+    , m_queryBridge(new QueryBridge(this))
+    , m_linkBridge(new LinkCheckBridge(this))
+    , m_imageHandler(new ImageSchemeHandler(this))
     , m_layout(new QVBoxLayout(this))
     , m_toolbar(new QToolBar(this))
+    , m_findBar(new FindReplaceBar(m_textEdit, this))
     , m_toggleButton(new QPushButton("View Mode", this))
     , m_saveTimer(new QTimer(this))
     , m_previewTimer(new QTimer(this))
+    , m_scrollSyncTimer(new QTimer(this))
+    , m_outlineTimer(new QTimer(this))
+    , m_previewIdleTimer(new QTimer(this))
+    , m_undoSaveTimer(new QTimer(this))
 {
     // Initialize the formatting toolbar (includes toggle button)
     initToolbar();
 
-    // Add widgets to the stacked widget
-    m_stackedWidget->addWidget(m_textEdit);
-    m_stackedWidget->addWidget(m_webView);
+    // Editor and preview share a splitter; the view mode decides which of them are shown
+    m_splitter->addWidget(m_textEdit);
+    m_splitter->addWidget(m_webView);
+    m_splitter->setChildrenCollapsible(false);
+    m_webView->hide();
+
+    // The outline sits to the left of both
+    m_outlineSplitter->addWidget(m_outlinePanel);
+    m_outlineSplitter->addWidget(m_splitter);
+    m_outlineSplitter->setStretchFactor(1, 1);
+    m_outlineSplitter->setChildrenCollapsible(false);
+    m_outlinePanel->hide();
 
     // Set up the main layout
     m_layout->addWidget(m_toolbar);
-    m_layout->addWidget(m_stackedWidget);
+    m_layout->addWidget(m_findBar);
+    m_layout->addWidget(m_outlineSplitter);
+    m_findBar->hide();
     setLayout(m_layout);
 
     // Auto-save setup
@@ -65,16 +125,94 @@ NotesWidget::NotesWidget(QWidget* parent)
     m_previewTimer->setSingleShot(true);
     m_previewTimer->setInterval(500); // Update preview after 500ms of inactivity
 
+    // Split view scroll sync, throttled to the display refresh rate in setViewMode()
+    m_scrollSyncTimer->setSingleShot(true);
+
+    // Outline panel refresh, after heading edits settle
+    m_outlineTimer->setSingleShot(true);
+    m_outlineTimer->setInterval(300);
+
+    // Idle preview teardown, see setPreviewIdleTimeout()
+    m_previewIdleTimer->setSingleShot(true);
+
+    // Undo history save, after the first auto-save since the last one
+    m_undoSaveTimer->setSingleShot(true);
+    m_undoSaveTimer->setInterval(UNDO_SAVE_INTERVAL);
+
+    // Version history is written in the background, one snapshot at a time
+    m_historyQueue.setMaxThreadCount(1);
+
     // Set up the WebEngine view
     initWebView();
 
+    // Serve profile images to the preview as cached thumbnails
+    QWebEngineProfile* const webProfile = m_webView->page()->profile();
+    if (webProfile->urlSchemeHandler(ImageSchemeHandler::SCHEME) == nullptr) {
+        webProfile->installUrlSchemeHandler(ImageSchemeHandler::SCHEME, m_imageHandler);
+    }
+
     // setupMarkdownHighlighter();
 
     // Connect signals
     connect(m_textEdit, &QMarkdownTextEdit::textChanged, this, &NotesWidget::onTextChanged);
+    connect(m_textEdit, &NotesTextEdit::imagePasted, this, &NotesWidget::onImagePasted);
+    connect(m_textEdit, &NotesTextEdit::imageFilesPasted, this, &NotesWidget::onImageFilesPasted);
+    connect(m_textEdit, &NotesTextEdit::findRequested, m_findBar, &FindReplaceBar::activate);
+    connect(m_textEdit, &NotesTextEdit::findNextRequested, this, [this](const bool backward) {
+        if (!m_findBar->isVisible()) {
+            m_findBar->activate(false);
+        } else if (backward) {
+            m_findBar->findPrevious();
+        } else {
+            m_findBar->findNext();
+        }
+    });
     connect(m_saveTimer, &QTimer::timeout, this, &NotesWidget::saveNotes);
+    connect(m_undoSaveTimer, &QTimer::timeout, this, &NotesWidget::saveUndoLog);
+    connect(m_textEdit, &NotesTextEdit::undoLogLoaded, this, [this] {
+        if (m_undoLogDirty && !m_undoSaveTimer->isActive()) {
+            m_undoSaveTimer->start();
+        }
+    });
     connect(m_toggleButton, &QPushButton::clicked, this, &NotesWidget::toggleViewMode);
     connect(m_previewTimer, &QTimer::timeout, this, &NotesWidget::updatePreview);
+    connect(m_scrollSyncTimer, &QTimer::timeout, this, &NotesWidget::syncPreviewToEditor);
+    connect(m_textEdit->verticalScrollBar(), &QScrollBar::valueChanged, this, [this] {
+        // Throttle rather than debounce, so the preview follows while scrolling
+        if (m_viewMode == ViewMode::Split && !m_syncingFromPreview && !m_scrollSyncTimer->isActive()) {
+            m_scrollSyncTimer->start();
+        }
+    });
+    connect(m_previewBridge, &PreviewBridge::layoutChanged, this, &NotesWidget::onPreviewLayoutChanged);
+    connect(m_previewBridge, &PreviewBridge::scrolled, this, &NotesWidget::onPreviewScrolled);
+
+    // The outline, task and mod mention indexes only re-examine the blocks a change touched
+    connect(m_textEdit->document(), &QTextDocument::contentsChange, this, [this](int position, int, int added) {
+        if (m_outline.update(m_textEdit->document(), position, added) && m_outlinePanel->isVisible()) {
+            m_outlineTimer->start();
+        }
+        const int openTasks = m_tasks.openCount();
+        m_tasks.update(m_textEdit->document(), position, added);
+        if (m_tasks.openCount() != openTasks) {
+            emit openTaskCountChanged(m_tasks.openCount());
+        }
+        if (m_mentions.update(m_textEdit->document(), position, added)) {
+            emit modMentionsChanged();
+        }
+        m_pluginMentions.update(m_textEdit->document(), position, added);
+    });
+    connect(m_outlineTimer, &QTimer::timeout, this, &NotesWidget::refreshOutline);
+    connect(m_previewIdleTimer, &QTimer::timeout, this, &NotesWidget::suspendPreview);
+    connect(m_outlinePanel, &OutlinePanel::headingActivated, this, &NotesWidget::jumpToHeading);
+    connect(m_outlinePanel, &OutlinePanel::foldRequested, this, &NotesWidget::foldSection);
+    connect(m_outlinePanel, &OutlinePanel::foldAllRequested, this, &NotesWidget::foldAllSections);
+    connect(m_textEdit, &NotesTextEdit::contextMenuRequested, this, &NotesWidget::addFoldActions);
+    m_textEdit->setCompletionIndex(&m_completions);
+    connect(this, &NotesWidget::modMentionsChanged, this, [this] { m_queryBridge->invalidate(ModQuery::Notes); });
+    connect(m_textEdit, &NotesTextEdit::foldsChanged, this, [this] {
+        m_foldsDirty = true;
+        m_saveTimer->start();
+    });
 }
 
 NotesWidget::~NotesWidget()
@@ -83,13 +221,31 @@ NotesWidget::~NotesWidget()
     m_saveTimer->stop();
     // Force final save to ensure no data is lost on shutdown
     saveNotes();
+    saveUndoLog();
 }
 
-void NotesWidget::initWebView() const
+void NotesWidget::initWebView()
 {
-    // Create and set custom page
-    const auto customPage = new NotesWebPage(m_webView);
+    // Create and set custom page, disposing of the one from the previous profile
+    QWebEnginePage* const oldPage = m_webView->page();
+    const auto customPage         = new NotesWebPage(m_webView);
     m_webView->setPage(customPage);
+    if (qobject_cast<NotesWebPage*>(oldPage) != nullptr) {
+        oldPage->deleteLater();
+    }
+
+    // Expose the bridge used for scroll sync and the ones serving log viewers, mod list queries and link checks
+    const auto channel = new QWebChannel(customPage);
+    channel->registerObject(QStringLiteral("bridge"), m_previewBridge);
+    channel->registerObject(QStringLiteral("logs"), m_logBridge);
+    channel->registerObject(QStringLiteral("queries"), m_queryBridge);
+    channel->registerObject(QStringLiteral("links"), m_linkBridge);
+    m_logBridge->closeAll();
+    customPage->setWebChannel(channel);
+
+    m_pageLoaded       = false;
+    m_previewUpToDate  = false;
+    m_previewSuspended = false;
 
     // Enable basic settings
     m_webView->settings()->setAttribute(QWebEngineSettings::JavascriptEnabled, true);
@@ -97,6 +253,195 @@ void NotesWidget::initWebView() const
     m_webView->settings()->setAttribute(QWebEngineSettings::LocalContentCanAccessRemoteUrls, false);
 
     // Load the stylesheet
+    m_previewStyleSheet = loadPreviewStyleSheet(m_profilePath);
+
+    QString cachedHtml;
+    bool cachedUpToDate = false;
+    if (!m_suspendedHtml.isEmpty()) {
+        // Back from an idle teardown: start from the captured content. If the text changed meanwhile,
+        // the next update only re-renders the blocks that differ.
+        cachedHtml     = std::exchange(m_suspendedHtml, QString());
+        cachedUpToDate = m_suspendedKey == PreviewCache::key(m_textEdit->toPlainText(), m_previewStyleSheet);
+    } else if (m_viewMode == ViewMode::View && !m_profilePath.isEmpty()) {
+        // In view mode, show the HTML rendered for this text and stylesheet last time instead of parsing again
+        cachedHtml = PreviewCache::load(
+            m_profilePath + "/notes.html.cache", PreviewCache::key(m_textEdit->toPlainText(), m_previewStyleSheet));
+        cachedUpToDate = !cachedHtml.isEmpty();
+    }
+
+    // m_webView->page()->setUrlRequestInterceptor(new UrlRequestInterceptor());
+
+    // Load the initial HTML with the markdown renderer - HTML string will be provided separately
+    const QString page = QString(R"(<!DOCTYPE html>
+<html>
+<head>
+    <meta charset="utf-8">
+    <title>Markdown Preview</title>
+    <script src="qrc:///qtwebchannel/qwebchannel.js"></script>
+    <script src="qrc:/resources/marked.min.js"></script>
+    <script src="qrc:/resources/codetokens.js"></script>
+    <script src="qrc:/resources/logview.js"></script>
+    <script src="qrc:/resources/modquery.js"></script>
+    <script src="qrc:/resources/linkcheck.js"></script>
+    <script src="qrc:/resources/preview.js"></script>
+    <style>
+    %1
+    </style>
+</head>
+<body>
+    <div id="content">%2</div>
+</body>
+</html>)");
+
+    const QString emptyPage  = page.arg(m_previewStyleSheet, QString());
+    const QString filledPage = cachedHtml.isEmpty() ? QString() : page.arg(m_previewStyleSheet, cachedHtml);
+    bool prefilled           = !filledPage.isEmpty() && fitsDataUrl(filledPage);
+
+    // The page loads asynchronously; render once it is ready if the preview is showing
+    connect(customPage, &QWebEnginePage::loadFinished, this, [this, emptyPage, prefilled](const bool ok) mutable {
+        if (!ok && std::exchange(prefilled, false)) {
+            // The cached content did not load after all; render into the empty page instead
+            m_previewUpToDate = false;
+            m_webView->setHtml(emptyPage);
+            return;
+        }
+        m_pageLoaded = ok;
+        if (ok && m_viewMode != ViewMode::Edit) {
+            updatePreview();
+        }
+        if (ok && m_restoreScroll >= 0) {
+            m_webView->page()->runJavaScript(QString("window.scrollTo(0, %1);").arg(m_restoreScroll));
+            m_restoreScroll = -1;
+        }
+    });
+
+    if (prefilled) {
+        m_webView->setHtml(filledPage);
+        m_previewUpToDate = cachedUpToDate;
+    } else {
+        m_webView->setHtml(emptyPage);
+    }
+}
+
+void NotesWidget::setPreviewIdleTimeout(const int minutes)
+{
+    m_previewIdleTimer->setInterval(std::max(0, minutes) * 60 * 1000);
+    updatePreviewVisibility(isVisible());
+}
+
+void NotesWidget::appendChangelogEntry(const QString& entry)
+{
+    if (m_profilePath.isEmpty() || entry.isEmpty()) {
+        return;
+    }
+
+    QTextDocument* const document               = m_textEdit->document();
+    const QList<OutlineIndex::Heading> headings = m_outline.headings();
+    const auto section = std::find_if(headings.cbegin(), headings.cend(), [](const OutlineIndex::Heading& heading) {
+        return heading.title.compare(u"Changelog", Qt::CaseInsensitive) == 0;
+    });
+
+    // The entry goes after the last line of the section, which is started at the end of the notes if there is none
+    QTextCursor cursor(document);
+    QString text;
+    if (section == headings.cend()) {
+        cursor.movePosition(QTextCursor::End);
+        if (!document->isEmpty()) {
+            text = document->lastBlock().text().isEmpty() ? "\n" : "\n\n";
+        }
+        text += "## Changelog\n\n" + entry + "\n";
+    } else {
+        int last = OutlineIndex::sectionEnd(headings, section - headings.cbegin(), document->blockCount()) - 1;
+        while (last > section->block && document->findBlockByNumber(last).text().trimmed().isEmpty()) {
+            --last;
+        }
+        const QTextBlock block = document->findBlockByNumber(last);
+        cursor.setPosition(block.position() + block.length() - 1);
+        text = (last == section->block ? "\n\n" : "\n") + entry;
+    }
+    m_textEdit->editAsStep(cursor, [&] { cursor.insertText(text); });
+
+    // One save per entry rather than waiting for the auto-save
+    m_saveTimer->stop();
+    saveNotes();
+}
+
+void NotesWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    updatePreviewVisibility(true);
+}
+
+void NotesWidget::hideEvent(QHideEvent* event)
+{
+    QWidget::hideEvent(event);
+    updatePreviewVisibility(false);
+}
+
+void NotesWidget::updatePreviewVisibility(const bool widgetVisible)
+{
+    const bool shown = widgetVisible && m_viewMode != ViewMode::Edit;
+    m_logBridge->setPolling(shown);
+    if (shown) {
+        m_previewIdleTimer->stop();
+        if (m_previewSuspended) {
+            // Recreate the page from the content captured before it was discarded
+            initWebView();
+        }
+    } else if (m_previewIdleTimer->interval() > 0 && !m_previewSuspended && !m_previewIdleTimer->isActive()) {
+        m_previewIdleTimer->start();
+    }
+}
+
+void NotesWidget::suspendPreview()
+{
+    if (m_previewSuspended || !m_pageLoaded || (isVisible() && m_viewMode != ViewMode::Edit)) {
+        return;
+    }
+
+    // Capture what the page shows, then let WebEngine free the page and its renderer
+    const QPointer page = m_webView->page();
+    page->runJavaScript("[NotesPreview.snapshot(), window.scrollY];",
+        [this, page](const QVariant& result) {
+            // The preview may have been shown again or replaced while capturing
+            const QVariantList values = result.toList();
+            if (page.isNull() || page != m_webView->page() || (isVisible() && m_viewMode != ViewMode::Edit)
+                || values.size() != 2) {
+                return;
+            }
+            m_suspendedKey.clear();
+            if (m_previewUpToDate) {
+                m_suspendedKey = PreviewCache::key(m_textEdit->toPlainText(), m_previewStyleSheet);
+            }
+            m_suspendedHtml    = values[0].toString();
+            m_restoreScroll    = values[1].toDouble();
+            m_previewSuspended = true;
+            m_pageLoaded       = false;
+            m_logBridge->closeAll();
+            page->setLifecycleState(QWebEnginePage::LifecycleState::Discarded);
+        });
+}
+
+void NotesWidget::cachePreviewHtml() const
+{
+    if (!m_pageLoaded) {
+        return;
+    }
+
+    // Runs after the update script, so this is the HTML of the text rendered last
+    m_webView->page()->runJavaScript("NotesPreview.snapshot();",
+        [path = m_profilePath + "/notes.html.cache",
+            key = PreviewCache::key(m_textEdit->toPlainText(), m_previewStyleSheet)](const QVariant& html) {
+            QThreadPool::globalInstance()->start([path, key, html = html.toString()] {
+                if (!html.isEmpty() && !PreviewCache::store(path, key, html)) {
+                    qWarning() << "Failed to write preview cache to:" << path;
+                }
+            });
+        });
+}
+
+QString NotesWidget::loadPreviewStyleSheet(const QString& profilePath)
+{
     QString styleSheet;
     QFile styleFile(":/resources/notes_style.css");
     if (styleFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -106,8 +451,8 @@ void NotesWidget::initWebView() const
     }
 
     // For external file support, also check profile directory
-    if (!m_profilePath.isEmpty()) {
-        const QString customCssPath = m_profilePath + "/notes_style.css";
+    if (!profilePath.isEmpty()) {
+        const QString customCssPath = profilePath + "/notes_style.css";
         QFile customFile(customCssPath);
         if (customFile.exists() && customFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
             QTextStream stream(&customFile);
@@ -117,50 +462,7 @@ void NotesWidget::initWebView() const
         }
     }
 
-    // m_webView->page()->setUrlRequestInterceptor(new UrlRequestInterceptor());
-
-    // Load the initial HTML with the markdown renderer - HTML string will be provided separately
-    m_webView->setHtml(QString(R"(<!DOCTYPE html>
-<html>
-<head>
-    <meta charset="utf-8">
-    <title>Markdown Preview</title>
-    <script src="qrc:/resources/marked.min.js"></script>
-    <script>
-    // Configure marked options
-    marked.setOptions({
-        breaks: true,           // Add 'br' on single line breaks
-        gfm: true,              // Use GitHub Flavored Markdown
-        headerIds: true,        // Add IDs to headers
-        mangle: false,          // Don't escape HTML
-        sanitize: false,        // Don't sanitize HTML
-        smartLists: true,       // Use smarter list behavior
-        smartypants: true,      // Use smart punctuation
-        xhtml: false            // Don't use XHTML closing tags
-    });
-
-function updateContent(markdown) {
-    document.getElementById('content').innerHTML = marked.parse(markdown);
-
-    // Add click handler to make links open in external browser
-    const links = document.getElementsByTagName('a');
-    for (let i = 0; i < links.length; i++) {
-        links[i].addEventListener('click', function(e) {
-            e.preventDefault();
-            // This will trigger navigation that our interceptor can catch
-            window.location.href = this.href;
-        });
-    }
-}    </script>
-    <style>
-    %1
-    </style>
-</head>
-<body>
-    <div id="content"></div>
-</body>
-</html>)")
-            .arg(styleSheet));
+    return styleSheet;
 }
 
 void NotesWidget::applyEditorStyles() const
@@ -175,38 +477,321 @@ void NotesWidget::applyEditorStyles() const
 
 void NotesWidget::toggleViewMode()
 {
-    m_isEditMode = !m_isEditMode;
+    setViewMode(m_viewMode == ViewMode::View ? ViewMode::Edit : ViewMode::View);
+}
 
-    if (m_isEditMode) {
-        m_stackedWidget->setCurrentWidget(m_textEdit);
-        m_toggleButton->setText("View Mode");
-        // Show formatting actions in edit mode
-        for (QAction* action : m_toolbar->actions()) {
-            action->setVisible(true);
+void NotesWidget::toggleSplitView()
+{
+    setViewMode(m_viewMode == ViewMode::Split ? ViewMode::Edit : ViewMode::Split);
+}
+
+void NotesWidget::setViewMode(const ViewMode mode)
+{
+    m_viewMode = mode;
+
+    m_textEdit->setVisible(mode != ViewMode::View);
+    m_webView->setVisible(mode != ViewMode::Edit);
+    m_toggleButton->setText(mode == ViewMode::View ? "Edit Mode" : "View Mode");
+    m_splitAction->setChecked(mode == ViewMode::Split);
+
+    // Formatting actions are only useful while the editor is showing
+    // (toggle button, split and outline toggles, tools menu and spacer always stay visible)
+    for (QAction* action : m_toolbar->actions()) {
+        if (action != m_toggleAction && action != m_splitAction && action != m_outlineAction
+            && action != m_toolsAction && action != m_spacerAction) {
+            action->setVisible(mode != ViewMode::View);
         }
+    }
+
+    // The find bar works on the editor
+    if (mode == ViewMode::View && m_findBar->isVisible()) {
+        m_findBar->dismiss();
+    }
+
+    // Brings a discarded preview back, or starts counting down to discarding it
+    updatePreviewVisibility(isVisible());
+
+    if (mode == ViewMode::Split) {
+        // One sync per display frame while scrolling
+        const qreal refreshRate = screen() != nullptr ? screen()->refreshRate() : 60.0;
+        m_scrollSyncTimer->setInterval(std::max(1, qRound(1000.0 / refreshRate)));
+        m_splitter->setSizes({ 1, 1 });
     } else {
+        m_scrollSyncTimer->stop();
+        m_sourceMap.clear();
+    }
+
+    if (mode != ViewMode::Edit) {
         updatePreview();
-        m_stackedWidget->setCurrentWidget(m_webView);
-        m_toggleButton->setText("Edit Mode");
-        // Hide formatting actions in view mode (keep toggle button and spacer visible)
-        for (QAction* action : m_toolbar->actions()) {
-            if (action != m_toggleAction && action != m_spacerAction) {
-                action->setVisible(false);
-            }
-        }
     }
 }
 
-void NotesWidget::updatePreview() const
+void NotesWidget::updatePreview()
 {
+    // Called again from loadFinished
+    if (!m_pageLoaded) {
+        return;
+    }
+
+    const QString sync = m_viewMode == ViewMode::Split ? "true" : "false";
+    if (m_previewUpToDate) {
+        m_webView->page()->runJavaScript(QString("NotesPreview.setSyncEnabled(%1);").arg(sync));
+        return;
+    }
+
     QString markdownText = m_textEdit->toPlainText();
+    m_linkBridge->check(markdownText);
 
     // JavaScript string escaping
     markdownText.replace("\\", "\\\\").replace("'", "\\'").replace("\n", "\\n").replace("\r", "");
 
-    // Execute JavaScript to update the content
-    const QString script = QString("updateContent('%1');").arg(markdownText);
+    // Execute JavaScript to update the content; block layout is only reported back while split
+    const QString script = QString("NotesPreview.setSyncEnabled(%1); updateContent('%2');").arg(sync, markdownText);
     m_webView->page()->runJavaScript(script);
+    m_previewUpToDate = true;
+
+    // Keep the rendering of the saved notes for the next start in view mode
+    if (!m_isDirty) {
+        cachePreviewHtml();
+    }
+}
+
+void NotesWidget::syncPreviewToEditor()
+{
+    if (m_viewMode != ViewMode::Split || m_sourceMap.isEmpty()) {
+        return;
+    }
+
+    // Fractional source line at the top of the editor viewport
+    const QTextBlock block = m_textEdit->cursorForPosition(QPoint(0, 0)).block();
+    const QRectF blockRect = m_textEdit->document()->documentLayout()->blockBoundingRect(block);
+    const QRect topRect    = m_textEdit->cursorRect(QTextCursor(block));
+    const double fraction
+        = blockRect.height() > 0 ? std::clamp(-topRect.top() / blockRect.height(), 0.0, 1.0) : 0.0;
+
+    const auto position = m_sourceMap.positionForLine(block.blockNumber() + fraction);
+    if (position.anchor < 0) {
+        return;
+    }
+    m_webView->page()->runJavaScript(
+        QString("NotesPreview.scrollToAnchor(%1, %2);").arg(position.anchor).arg(position.fraction));
+}
+
+void NotesWidget::onPreviewLayoutChanged(const QVariantList& layout)
+{
+    m_sourceMap.reset(layout);
+    syncPreviewToEditor();
+}
+
+void NotesWidget::onPreviewScrolled(const double offset)
+{
+    if (m_viewMode != ViewMode::Split || m_sourceMap.isEmpty()) {
+        return;
+    }
+
+    const double line      = m_sourceMap.lineForOffset(offset);
+    const QTextBlock block = m_textEdit->document()->findBlockByNumber(static_cast<int>(line));
+    if (!block.isValid()) {
+        return;
+    }
+
+    // The vertical scroll bar of a QPlainTextEdit counts layout lines, not pixels
+    const int lineInBlock = static_cast<int>((line - block.blockNumber()) * block.lineCount());
+    m_syncingFromPreview  = true;
+    m_textEdit->verticalScrollBar()->setValue(block.firstLineNumber() + lineInBlock);
+    m_syncingFromPreview = false;
+}
+
+void NotesWidget::toggleOutline(const bool visible)
+{
+    m_outlinePanel->setVisible(visible);
+    if (visible) {
+        refreshOutline();
+    }
+}
+
+void NotesWidget::refreshOutline()
+{
+    m_outlineTimer->stop();
+    m_outlinePanel->setHeadings(m_outline.headings());
+}
+
+void NotesWidget::jumpToHeading(const int index)
+{
+    const QList<OutlineIndex::Heading> headings = m_outline.headings();
+    if (index < 0 || index >= headings.size()) {
+        return;
+    }
+
+    jumpToLine(headings[index].block);
+}
+
+void NotesWidget::jumpToLine(const int line)
+{
+    // The preview blocks carry their source lines, so view mode can jump without a source map
+    if (m_viewMode == ViewMode::View) {
+        m_webView->page()->runJavaScript(QString("NotesPreview.scrollToLine(%1);").arg(line));
+        return;
+    }
+
+    const QTextBlock block = m_textEdit->document()->findBlockByNumber(line);
+    if (!block.isValid()) {
+        return;
+    }
+    m_textEdit->revealBlock(block);
+    m_textEdit->setTextCursor(QTextCursor(block));
+    m_textEdit->verticalScrollBar()->setValue(block.firstLineNumber());
+    m_textEdit->setFocus();
+}
+
+void NotesWidget::foldSection(const int index, const bool folded)
+{
+    const QList<OutlineIndex::Heading> headings = m_outline.headings();
+    if (index < 0 || index >= headings.size()) {
+        return;
+    }
+    const int end = OutlineIndex::sectionEnd(headings, index, m_textEdit->document()->blockCount());
+    m_textEdit->setBlocksFolded(headings[index].block + 1, end, folded);
+}
+
+void NotesWidget::foldAllSections(const bool folded)
+{
+    if (!folded) {
+        m_textEdit->setBlocksFolded(0, m_textEdit->document()->blockCount(), false);
+        return;
+    }
+
+    // Folding the top-level sections hides everything below them
+    const QList<OutlineIndex::Heading> headings = m_outline.headings();
+    const int blockCount                        = m_textEdit->document()->blockCount();
+    int foldedUntil                             = -1;
+    for (qsizetype i = 0; i < headings.size(); ++i) {
+        if (headings[i].block < foldedUntil) {
+            continue;
+        }
+        foldedUntil = OutlineIndex::sectionEnd(headings, i, blockCount);
+        m_textEdit->setBlocksFolded(headings[i].block + 1, foldedUntil, true);
+    }
+}
+
+void NotesWidget::foldAt(const int block, const bool folded)
+{
+    // The innermost fold around the block: a fenced code block, else the section the block is in
+    const int blockCount = m_textEdit->document()->blockCount();
+    for (const OutlineIndex::Fence& fence : m_outline.fences(blockCount)) {
+        if (fence.open > block) {
+            break;
+        }
+        if (block <= fence.close) {
+            m_textEdit->setBlocksFolded(fence.open + 1, fence.close + 1, folded);
+            return;
+        }
+    }
+
+    const QList<OutlineIndex::Heading> headings = m_outline.headings();
+    const auto after = std::upper_bound(headings.cbegin(), headings.cend(), block,
+        [](const int number, const OutlineIndex::Heading& heading) { return number < heading.block; });
+    if (after != headings.cbegin()) {
+        foldSection(static_cast<int>(after - headings.cbegin() - 1), folded);
+    }
+}
+
+void NotesWidget::addFoldActions(QMenu* menu, const QTextCursor& cursor)
+{
+    const int block       = cursor.blockNumber();
+    const QTextBlock next = cursor.block().next();
+    menu->addSeparator();
+    if (next.isValid() && !next.isVisible()) {
+        menu->addAction(tr("Unfold"), this, [this, next] { m_textEdit->revealBlock(next); });
+    } else {
+        menu->addAction(tr("Fold"), this, [this, block] { foldAt(block, true); });
+    }
+    menu->addAction(tr("Fold All"), this, [this] { foldAllSections(true); });
+    menu->addAction(tr("Unfold All"), this, [this] { foldAllSections(false); });
+}
+
+QList<NotesTextEdit::Fold> NotesWidget::loadFolds() const
+{
+    QList<NotesTextEdit::Fold> folds;
+    QFile file(m_profilePath + "/notes_folds.json");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return folds;
+    }
+    for (const QJsonValue& value : QJsonDocument::fromJson(file.readAll()).object().value("folds").toArray()) {
+        const QJsonObject fold = value.toObject();
+        folds.append({ fold.value("first").toInt(), fold.value("end").toInt(), fold.value("opener").toString() });
+    }
+    return folds;
+}
+
+void NotesWidget::saveFolds()
+{
+    m_foldsDirty = false;
+
+    // Written on the history queue, so a later save of the folds cannot be overtaken by an earlier one
+    m_historyQueue.start([folds = m_textEdit->folds(), path = m_profilePath + "/notes_folds.json"] {
+        if (folds.isEmpty()) {
+            QFile::remove(path);
+            return;
+        }
+
+        QJsonArray array;
+        for (const NotesTextEdit::Fold& fold : folds) {
+            array.append(QJsonObject { { "first", fold.first }, { "end", fold.end }, { "opener", fold.opener } });
+        }
+        QFile file(path);
+        const QByteArray json = QJsonDocument(QJsonObject { { "folds", array } }).toJson(QJsonDocument::Compact);
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size()) {
+            qWarning() << "Failed to save folds to:" << path;
+        }
+    });
+}
+
+void NotesWidget::showTasks()
+{
+    if (m_profilePath.isEmpty()) {
+        return;
+    }
+
+    const QFileInfo profile(m_profilePath);
+    auto* dialog = new TasksDialog(profile.absolutePath(), profile.fileName(), m_textEdit->toPlainText(), this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    connect(dialog, &TasksDialog::taskActivated, this, &NotesWidget::jumpToLine);
+    dialog->show();
+}
+
+void NotesWidget::showQuickOpen()
+{
+    if (m_profilePath.isEmpty()) {
+        return;
+    }
+
+    // Every enabled toolbar command, including those in the toolbar's menus
+    QList<QuickOpenDialog::Command> commands;
+    const std::function<void(const QList<QAction*>&)> addCommands = [&](const QList<QAction*>& actions) {
+        for (QAction* action : actions) {
+            if (action->isSeparator() || !action->isEnabled() || action == m_quickOpenAction) {
+                continue;
+            }
+            if (action->menu() != nullptr) {
+                addCommands(action->menu()->actions());
+            } else if (const auto* button = qobject_cast<QToolButton*>(m_toolbar->widgetForAction(action))) {
+                if (button->menu() != nullptr) {
+                    addCommands(button->menu()->actions());
+                }
+            } else if (!action->toolTip().isEmpty() && m_toolbar->widgetForAction(action) != m_toggleButton) {
+                commands.append({ action->toolTip().remove('&'), action });
+            }
+        }
+    };
+    addCommands(m_toolbar->actions());
+
+    const QFileInfo profile(m_profilePath);
+    auto* dialog = new QuickOpenDialog(m_outline.headings(), commands, profile.absolutePath(), profile.fileName(),
+        m_textEdit->toPlainText(), this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    connect(dialog, &QuickOpenDialog::lineActivated, this, &NotesWidget::jumpToLine);
+    dialog->show();
 }
 
 void NotesWidget::setupMarkdownHighlighter() const
@@ -408,7 +993,25 @@ void NotesWidget::setProfilePath(const QString& profilePath)
     // Stop any pending save timer before changing profile
     m_saveTimer->stop();
 
+    // The undo history of the previous profile is otherwise only saved on the next timeout
+    saveUndoLog();
+    m_undoLogDirty = false;
+
+    // Attachments still being stored and generated text belong to the previous document
+    m_pendingInsertions.clear();
+
+    // A preview captured before an idle teardown shows the previous profile
+    m_suspendedHtml.clear();
+    m_restoreScroll = -1;
+
+    // References in the notes of the new profile may still be being rewritten, and its history written to
+    m_historyQueue.waitForDone();
+
     m_profilePath = profilePath;
+    m_imageHandler->setProfilePath(profilePath);
+    m_logBridge->setBaseDirectory(profilePath);
+    m_linkBridge->setProfilePath(profilePath);
+    m_history = std::make_shared<HistoryStore>(m_profilePath + "/notes_history");
 
     // Reset retry count for new profile
     m_saveRetryCount = 0;
@@ -419,6 +1022,7 @@ void NotesWidget::setProfilePath(const QString& profilePath)
 
     // Load notes content
     const QString notesFilePath = m_profilePath + "/notes.md";
+    const QString undoLogPath   = m_profilePath + "/notes.undo";
     QFile file(notesFilePath);
 
     // Block signals during load to prevent triggering onTextChanged
@@ -426,11 +1030,11 @@ void NotesWidget::setProfilePath(const QString& profilePath)
 
     if (file.exists() && file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QTextStream in(&file);
-        m_textEdit->setPlainText(in.readAll());
+        m_textEdit->loadText(in.readAll(), undoLogPath, loadFolds());
         file.close();
     } else {
         // Set default welcome content if no file exists
-        m_textEdit->setPlainText(DefaultContent::WELCOME_MARKDOWN);
+        m_textEdit->loadText(DefaultContent::WELCOME_MARKDOWN, undoLogPath);
         // Save the default content
         if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
             QTextStream out(&file);
@@ -439,9 +1043,10 @@ void NotesWidget::setProfilePath(const QString& profilePath)
         }
     }
 
-    // Restore signals and reset dirty flag
+    // Restore signals and reset dirty flags
     m_textEdit->blockSignals(false);
-    m_isDirty = false;
+    m_isDirty    = false;
+    m_foldsDirty = false;
 
     // Apply styles to components
     initWebView(); // This loads preview styles
@@ -451,31 +1056,14 @@ void NotesWidget::setProfilePath(const QString& profilePath)
 
 void NotesWidget::setDefaultToViewMode(bool viewMode)
 {
-    if (viewMode && m_isEditMode) {
-        // Switch to view mode
-        m_isEditMode = false;
-        updatePreview();
-        m_stackedWidget->setCurrentWidget(m_webView);
-        m_toggleButton->setText("Edit Mode");
-        // Hide formatting actions in view mode (keep toggle button and spacer visible)
-        for (QAction* action : m_toolbar->actions()) {
-            if (action != m_toggleAction && action != m_spacerAction) {
-                action->setVisible(false);
-            }
-        }
-    } else if (!viewMode && !m_isEditMode) {
-        // Switch to edit mode
-        m_isEditMode = true;
-        m_stackedWidget->setCurrentWidget(m_textEdit);
-        m_toggleButton->setText("View Mode");
-        // Show formatting actions in edit mode
-        for (QAction* action : m_toolbar->actions()) {
-            action->setVisible(true);
-        }
+    if (viewMode && m_viewMode != ViewMode::View) {
+        setViewMode(ViewMode::View);
+    } else if (!viewMode && m_viewMode == ViewMode::View) {
+        setViewMode(ViewMode::Edit);
     }
 }
 
-void NotesWidget::reloadStyles() const
+void NotesWidget::reloadStyles()
 {
     // Reload preview stylesheet
     initWebView();
@@ -484,25 +1072,33 @@ void NotesWidget::reloadStyles() const
     applyEditorStyles();
 
     // Update preview if needed
-    if (!m_isEditMode) {
+    if (m_viewMode != ViewMode::Edit) {
         updatePreview();
     }
 }
 
 void NotesWidget::onTextChanged()
 {
-    m_isDirty = true;
+    m_isDirty         = true;
+    m_previewUpToDate = false;
     m_saveTimer->start(); // Restart the timer on each text change
 
     // Start preview timer to update the preview if it's visible
-    if (!m_isEditMode) {
+    if (m_viewMode != ViewMode::Edit) {
         m_previewTimer->start();
     }
 }
 
 void NotesWidget::saveNotes()
 {
-    if (!m_isDirty || m_profilePath.isEmpty()) {
+    if (m_profilePath.isEmpty()) {
+        return;
+    }
+    if (!m_isDirty) {
+        // Folding alone leaves the text as it is
+        if (m_foldsDirty) {
+            saveFolds();
+        }
         return;
     }
 
@@ -510,12 +1106,33 @@ void NotesWidget::saveNotes()
     QFile file(notesFilePath);
 
     if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        const QString text = m_textEdit->toPlainText();
         QTextStream out(&file);
-        out << m_textEdit->toPlainText();
+        out << text;
         file.close();
         m_isDirty        = false;
         m_saveRetryCount = 0; // Reset retry count on success
         qDebug() << "Notes saved to:" << notesFilePath;
+
+        // Fold positions move with the text
+        saveFolds();
+
+        if (m_previewUpToDate && m_viewMode != ViewMode::Edit) {
+            cachePreviewHtml();
+        }
+
+        // Snapshot the saved text as a new version
+        m_historyQueue.start([history = m_history, text, maxAgeDays = m_historyMaxAgeDays,
+                                 sizeBudget = m_historySizeBudget] {
+            history->record(text);
+            history->prune(maxAgeDays, sizeBudget);
+        });
+
+        // Keep the undo history with the text it leads up to, though not on every save
+        m_undoLogDirty = true;
+        if (!m_undoSaveTimer->isActive()) {
+            m_undoSaveTimer->start();
+        }
     } else {
         m_saveRetryCount++;
         qWarning() << "Failed to save notes to:" << notesFilePath << "(attempt" << m_saveRetryCount << "of"
@@ -539,6 +1156,221 @@ void NotesWidget::saveNotes()
     }
 }
 
+void NotesWidget::saveUndoLog()
+{
+    m_undoSaveTimer->stop();
+    // The history is only valid for the text on disk, and is not written without the saved part it was read from
+    if (!m_undoLogDirty || m_profilePath.isEmpty() || m_isDirty || !m_textEdit->isUndoLogLoaded()) {
+        return;
+    }
+    m_undoLogDirty = false;
+
+    m_historyQueue.start([undoLog = m_textEdit->undoLog(), text = m_textEdit->rawText(),
+                             path = m_profilePath + "/notes.undo"] {
+        if (!undoLog.save(path, text)) {
+            qWarning() << "Failed to save undo history to:" << path;
+        }
+    });
+}
+
+void NotesWidget::exportAllProfiles()
+{
+    if (m_profilePath.isEmpty()) {
+        return;
+    }
+
+    const QString outputDirectory
+        = QFileDialog::getExistingDirectory(this, tr("Export Notes of All Profiles"), m_lastExportDirectory);
+    if (outputDirectory.isEmpty()) {
+        return;
+    }
+    m_lastExportDirectory = outputDirectory;
+
+    // Export what is on screen for the current profile
+    saveNotes();
+
+    const auto exporter = new NotesExporter(QFileInfo(m_profilePath).absolutePath(), outputDirectory, this);
+    const QPointer progress(new QProgressDialog(tr("Exporting notes..."), QString(), 0, 0, this));
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setMinimumDuration(500);
+
+    connect(exporter, &NotesExporter::progress, progress, [progress](const int done, const int total) {
+        progress->setMaximum(total);
+        progress->setValue(done);
+    });
+    connect(exporter, &NotesExporter::finished, this,
+        [this, progress, outputDirectory](const int exported, const int unchanged) {
+            if (!progress.isNull()) {
+                progress->close();
+            }
+            QMessageBox::information(this, tr("Export Finished"),
+                tr("Exported %1 profile(s) to:\n%2\n\n%3 profile(s) were unchanged since the last export.")
+                    .arg(exported)
+                    .arg(outputDirectory)
+                    .arg(unchanged));
+        });
+
+    exporter->start();
+}
+
+void NotesWidget::setHistoryLimits(const int maxAgeDays, const qint64 sizeBudget)
+{
+    m_historyMaxAgeDays = maxAgeDays;
+    m_historySizeBudget = sizeBudget;
+}
+
+void NotesWidget::setUndoMemoryBudget(const qsizetype bytes) { m_textEdit->setUndoMemoryBudget(bytes); }
+
+void NotesWidget::setModNames(const QStringList& names)
+{
+    m_mentions.setModNames(names, m_textEdit->document());
+    m_completions.setNames(CompletionIndex::Kind::Mod, names);
+    emit modMentionsChanged();
+}
+
+void NotesWidget::setModQuerySources(
+    std::function<QList<ModQuery::Mod>()> mods, std::function<QList<ModQuery::Plugin>()> plugins)
+{
+    m_queryBridge->setSources(std::move(mods), std::move(plugins), [this](const QString& mod) {
+        return m_mentions.presence(mod) != ModMentionIndex::Presence::None;
+    });
+}
+
+void NotesWidget::setPluginNames(const QStringList& names)
+{
+    // The plugin list is refreshed far more often than plugins come and go; reindexing is only worth a change
+    QStringList sorted = names;
+    sorted.sort(Qt::CaseInsensitive);
+    if (sorted == m_pluginNames) {
+        return;
+    }
+    m_pluginNames = sorted;
+
+    m_pluginMentions.setModNames(names, m_textEdit->document());
+    m_linkBridge->setPluginNames(names);
+    m_completions.setNames(CompletionIndex::Kind::Plugin, names);
+}
+
+void NotesWidget::renameReferences(
+    const QList<ReferenceRewrite::Rename>& mods, const QList<ReferenceRewrite::Rename>& plugins)
+{
+    const QList<ReferenceRewrite::Rename> renames = mods + plugins;
+    if (renames.isEmpty()) {
+        return;
+    }
+
+    // Only the blocks the indexes list as mentioning an old name are looked at
+    QList<int> blocks;
+    for (const ReferenceRewrite::Rename& rename : mods) {
+        blocks.append(m_mentions.blocksMentioning(rename.from));
+    }
+    for (const ReferenceRewrite::Rename& rename : plugins) {
+        blocks.append(m_pluginMentions.blocksMentioning(rename.from));
+    }
+    std::ranges::sort(blocks);
+    blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+
+    // Names hold no line breaks, so block numbers stay valid while replacing
+    QTextDocument* document = m_textEdit->document();
+    QTextCursor cursor(document);
+    m_textEdit->editAsStep(cursor, [&] {
+        for (const int number : blocks) {
+            const QTextBlock block                              = document->findBlockByNumber(number);
+            const QList<ReferenceRewrite::Reference> references = ReferenceRewrite::find(block.text(), renames);
+            for (auto it = references.crbegin(); it != references.crend(); ++it) {
+                cursor.setPosition(block.position() + static_cast<int>(it->from));
+                cursor.setPosition(
+                    block.position() + static_cast<int>(it->from + it->length), QTextCursor::KeepAnchor);
+                cursor.insertText(renames[it->rename].to);
+            }
+        }
+    });
+
+    // Mods and plugins are shared by all profiles; the notes of the others that refer to them are offered too
+    if (m_profilePath.isEmpty()) {
+        return;
+    }
+    const QFileInfo profile(m_profilePath);
+    QThreadPool::globalInstance()->start([widget = QPointer<NotesWidget>(this), renames,
+                                             profilesDirectory = profile.absolutePath(),
+                                             currentProfile    = profile.fileName()] {
+        QStringList profiles;
+        for (const QString& name : QDir(profilesDirectory).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+            QFile file(profilesDirectory + "/" + name + "/notes.md");
+            if (name != currentProfile && file.open(QIODevice::ReadOnly | QIODevice::Text)
+                && ReferenceRewrite::count(QString::fromUtf8(file.readAll()), renames) > 0) {
+                profiles.append(name);
+            }
+        }
+
+        QMetaObject::invokeMethod(qApp, [widget, renames, profilesDirectory, profiles] {
+            if (widget.isNull() || profiles.isEmpty()) {
+                return;
+            }
+            widget->rewriteOtherProfiles(profilesDirectory, profiles, renames);
+        });
+    });
+}
+
+void NotesWidget::rewriteOtherProfiles(
+    const QString& profilesDirectory, QStringList profiles, const QList<ReferenceRewrite::Rename>& renames)
+{
+    QStringList names;
+    for (const ReferenceRewrite::Rename& rename : renames) {
+        names.append(tr("%1 → %2").arg(rename.from, rename.to));
+    }
+    const auto answer = QMessageBox::question(this, tr("Update Other Profiles"),
+        tr("Renamed:\n%1\n\nThe notes of these profiles refer to the old name:\n%2\n\n"
+           "Update them too? Their current notes are kept in their history.")
+            .arg(names.join("\n"), profiles.join("\n")));
+    if (answer != QMessageBox::Yes) {
+        return;
+    }
+
+    // The profile may have been switched to one of them while asking; its notes are open in the editor.
+    // Queued with the history writes, so a switch to one of them waits for it before reading its notes.
+    profiles.removeAll(QFileInfo(m_profilePath).fileName());
+    m_historyQueue.start([renames, profilesDirectory, profiles] {
+        for (const QString& name : profiles) {
+            const QString directory = profilesDirectory + "/" + name;
+            QFile file(directory + "/notes.md");
+            if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                qWarning() << "Failed to read notes to rewrite references in:" << file.fileName();
+                continue;
+            }
+            HistoryStore(directory + "/notes_history").record(QString::fromUtf8(file.readAll()));
+            file.close();
+
+            QString error;
+            if (ReferenceRewrite::rewriteFile(file.fileName(), renames, &error) < 0) {
+                qWarning() << "Failed to rewrite references in:" << file.fileName() << error;
+            }
+        }
+    });
+}
+
+void NotesWidget::showHistory()
+{
+    if (!m_history) {
+        return;
+    }
+
+    // Make sure the latest text is part of the history
+    saveNotes();
+
+    auto* dialog = new HistoryDialog(m_history, m_textEdit->toPlainText(), this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    connect(dialog, &HistoryDialog::restoreRequested, this, [this](const QString& text) {
+        // Replace the document in one undoable step
+        QTextCursor cursor(m_textEdit->document());
+        m_textEdit->editAsStep(cursor, [&] {
+            cursor.select(QTextCursor::Document);
+            cursor.insertText(text);
+        });
+    });
+    dialog->show();
+}
+
 void NotesWidget::initToolbar()
 {
     m_toolbar->setMovable(false);
@@ -620,6 +1452,21 @@ void NotesWidget::initToolbar()
     checkboxAction->setToolTip(tr("Checkbox"));
     connect(checkboxAction, &QAction::triggered, this, &NotesWidget::insertCheckbox);
 
+    // Indent and outdent the selected lines, which nests and unnests list items
+    auto* outdentAction = m_toolbar->addAction("⇤");
+    outdentAction->setToolTip(tr("Outdent (Ctrl+[)"));
+    outdentAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_BracketLeft));
+    connect(outdentAction, &QAction::triggered, this, &NotesWidget::outdent);
+    auto* indentAction = m_toolbar->addAction("⇥");
+    indentAction->setToolTip(tr("Indent (Ctrl+])"));
+    indentAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_BracketRight));
+    connect(indentAction, &QAction::triggered, this, &NotesWidget::indent);
+    // Only while the notes have focus, so the keys are left to the rest of the organizer
+    for (QAction* action : { outdentAction, indentAction }) {
+        action->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+        addAction(action);
+    }
+
     m_toolbar->addSeparator();
 
     // Quote
@@ -632,11 +1479,54 @@ void NotesWidget::initToolbar()
     hrAction->setToolTip(tr("Horizontal Rule"));
     connect(hrAction, &QAction::triggered, this, &NotesWidget::insertHorizontalRule);
 
+    m_toolbar->addSeparator();
+
+    // Load order snapshots, available once the organizer provides the lists
+    auto* loadOrderButton = new QToolButton(this);
+    loadOrderButton->setText("⇅");
+    loadOrderButton->setToolTip(tr("Load Order"));
+    loadOrderButton->setPopupMode(QToolButton::InstantPopup);
+    auto* loadOrderMenu = new QMenu(loadOrderButton);
+    loadOrderMenu->addAction(tr("Insert Load Order Snapshot"), this, &NotesWidget::insertLoadOrderSnapshot);
+    loadOrderMenu->addAction(tr("Compare With Last Snapshot"), this, &NotesWidget::compareLoadOrder);
+    loadOrderButton->setMenu(loadOrderMenu);
+    m_loadOrderAction = m_toolbar->addWidget(loadOrderButton);
+    m_loadOrderAction->setEnabled(false);
+
     // Add spacer to push toggle button to the right
     auto* spacer = new QWidget(this);
     spacer->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
     m_spacerAction = m_toolbar->addWidget(spacer);
 
+    // Split view
+    m_splitAction = m_toolbar->addAction("◫");
+    m_splitAction->setToolTip(tr("Split View"));
+    m_splitAction->setCheckable(true);
+    connect(m_splitAction, &QAction::triggered, this, &NotesWidget::toggleSplitView);
+
+    // Outline panel
+    m_outlineAction = m_toolbar->addAction("☰");
+    m_outlineAction->setToolTip(tr("Outline"));
+    m_outlineAction->setCheckable(true);
+    connect(m_outlineAction, &QAction::toggled, this, &NotesWidget::toggleOutline);
+
+    // Tools menu for commands that are not about formatting
+    auto* toolsButton = new QToolButton(this);
+    toolsButton->setText("⋯");
+    toolsButton->setToolTip(tr("More"));
+    toolsButton->setPopupMode(QToolButton::InstantPopup);
+    m_toolsMenu = new QMenu(toolsButton);
+    m_toolsMenu->addAction(tr("History..."), this, &NotesWidget::showHistory);
+    m_toolsMenu->addAction(tr("Tasks in All Profiles..."), this, &NotesWidget::showTasks);
+    m_quickOpenAction = m_toolsMenu->addAction(tr("Quick Open..."), this, &NotesWidget::showQuickOpen);
+    m_quickOpenAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_P));
+    m_quickOpenAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    addAction(m_quickOpenAction); // so the shortcut works while the menu is closed
+    m_toolsMenu->addSeparator();
+    m_toolsMenu->addAction(tr("Export All Profiles to HTML..."), this, &NotesWidget::exportAllProfiles);
+    toolsButton->setMenu(m_toolsMenu);
+    m_toolsAction = m_toolbar->addWidget(toolsButton);
+
     // Add toggle button at the end
     m_toggleAction = m_toolbar->addWidget(m_toggleButton);
 }
@@ -648,38 +1538,140 @@ void NotesWidget::wrapSelection(const QString& before, const QString& after)
 
     if (selectedText.isEmpty()) {
         // No selection - insert placeholder
-        cursor.insertText(before + tr("text") + after);
+        m_textEdit->editAsStep(cursor, [&] { cursor.insertText(before + tr("text") + after); });
         // Move cursor to select the placeholder
         cursor.movePosition(QTextCursor::Left, QTextCursor::MoveAnchor, after.length());
         cursor.movePosition(QTextCursor::Left, QTextCursor::KeepAnchor, 4); // "text" length
     } else {
         // Wrap selected text
-        cursor.insertText(before + selectedText + after);
+        m_textEdit->editAsStep(cursor, [&] { cursor.insertText(before + selectedText + after); });
     }
     m_textEdit->setTextCursor(cursor);
     m_textEdit->setFocus();
 }
 
-void NotesWidget::insertAtLineStart(const QString& prefix)
+std::pair<int, QStringList> NotesWidget::selectedLines() const
 {
-    QTextCursor cursor = m_textEdit->textCursor();
-    cursor.movePosition(QTextCursor::StartOfLine);
-    cursor.insertText(prefix);
+    const QTextCursor cursor      = m_textEdit->textCursor();
+    const QTextDocument* document = m_textEdit->document();
+    const QTextBlock first        = document->findBlock(cursor.selectionStart());
+    QTextBlock last               = document->findBlock(cursor.selectionEnd());
+    // A selection ending at the start of a line does not take that line in
+    if (last != first && cursor.selectionEnd() == last.position()) {
+        last = last.previous();
+    }
+
+    QStringList lines;
+    for (QTextBlock block = first; block.isValid() && block.blockNumber() <= last.blockNumber(); block = block.next()) {
+        lines.append(block.text());
+    }
+    return { first.blockNumber(), lines };
+}
+
+void NotesWidget::replaceSelectedLines(const int first, const QStringList& lines)
+{
+    QTextCursor cursor     = m_textEdit->textCursor();
+    const bool selection   = cursor.hasSelection();
+    const int column       = cursor.positionInBlock();
+    const int lengthBefore = cursor.block().length();
+
+    // One edit, so one undo step, one textChanged and one highlighting pass for all the lines
+    m_textEdit->replaceLines(first, lines);
+
+    const QTextDocument* document = m_textEdit->document();
+    const QTextBlock firstBlock   = document->findBlockByNumber(first);
+    if (selection) {
+        const QTextBlock lastBlock = document->findBlockByNumber(first + static_cast<int>(lines.size()) - 1);
+        cursor.setPosition(firstBlock.position());
+        cursor.setPosition(lastBlock.position() + lastBlock.length() - 1, QTextCursor::KeepAnchor);
+    } else {
+        // The cursor keeps its place in the text of the line
+        const int shifted = column + firstBlock.length() - lengthBefore;
+        cursor.setPosition(firstBlock.position() + std::clamp(shifted, 0, firstBlock.length() - 1));
+    }
     m_textEdit->setTextCursor(cursor);
     m_textEdit->setFocus();
 }
 
+void NotesWidget::toggleLinePrefix(const QString& prefix)
+{
+    // The markers each kind of prefix replaces: headings at the start of the line, list markers after the
+    // indentation, which is kept so nested lists stay nested, and quotes
+    static const QRegularExpression headingRe(R"(^#{1,6}[ \t]+)");
+    static const QRegularExpression listRe(R"(^([ \t]*)([-*+][ \t]+\[[ xX]\][ \t]+|[-*+][ \t]+|\d+[.)][ \t]+))");
+    static const QRegularExpression quoteRe(R"(^>[ \t]?)");
+    static const QRegularExpression checkedRe(R"(\[[xX]\])");
+    static const QRegularExpression bulletRe(R"(^[*+])");
+    static const QRegularExpression numberRe(R"(^\d+[.)])");
+
+    const bool heading                 = prefix.startsWith(u'#');
+    const bool quote                   = prefix.startsWith(u'>');
+    const bool numbered                = prefix.front().isDigit();
+    const QRegularExpression& markerRe = heading ? headingRe : quote ? quoteRe : listRe;
+    const int markerGroup              = heading || quote ? 0 : 2;
+
+    // Any number is a numbered list, any bullet a bullet list, and checked boxes are checkboxes
+    const auto isPrefix = [&](const QRegularExpressionMatch& match) {
+        if (!match.hasMatch()) {
+            return false;
+        }
+        QString marker = match.captured(markerGroup);
+        if (numbered) {
+            return numberRe.match(marker).hasMatch();
+        }
+        return marker.replace(checkedRe, "[ ]").replace(bulletRe, "-").simplified() == prefix.simplified();
+    };
+
+    auto [first, lines] = selectedLines();
+    const bool anyText  = std::ranges::any_of(lines, [](const QString& line) { return !line.trimmed().isEmpty(); });
+    const auto affected = [anyText](const QString& line) { return !anyText || !line.trimmed().isEmpty(); };
+    const bool remove   = std::ranges::all_of(
+        lines, [&](const QString& line) { return !affected(line) || isPrefix(markerRe.match(line)); });
+
+    int number = 1;
+    for (QString& line : lines) {
+        if (!affected(line)) {
+            continue;
+        }
+        const QRegularExpressionMatch match = markerRe.match(line);
+        if (remove) {
+            line.remove(match.capturedStart(markerGroup), match.capturedLength(markerGroup));
+        } else if (!isPrefix(match) || numbered) {
+            const qsizetype at = match.hasMatch() ? match.capturedStart(markerGroup) : 0;
+            line.remove(at, match.capturedLength(markerGroup));
+            line.insert(heading || quote ? 0 : at, numbered ? QString("%1. ").arg(number++) : prefix);
+        }
+    }
+    replaceSelectedLines(first, lines);
+}
+
+void NotesWidget::indentLines(const bool outdent)
+{
+    static const QString indentation(INDENT_WIDTH, u' ');
+    static const QRegularExpression outdentRe(QString(R"(^(?:\t| {1,%1}))").arg(INDENT_WIDTH));
+
+    auto [first, lines] = selectedLines();
+    for (QString& line : lines) {
+        if (outdent) {
+            line.remove(outdentRe);
+        } else if (!line.trimmed().isEmpty() || lines.size() == 1) {
+            line.prepend(indentation);
+        }
+    }
+    replaceSelectedLines(first, lines);
+}
+
 void NotesWidget::insertBold() { wrapSelection("**", "**"); }
 
 void NotesWidget::insertItalic() { wrapSelection("*", "*"); }
 
 void NotesWidget::insertStrikethrough() { wrapSelection("~~", "~~"); }
 
-void NotesWidget::insertHeading1() { insertAtLineStart("# "); }
+void NotesWidget::insertHeading1() { toggleLinePrefix("# "); }
 
-void NotesWidget::insertHeading2() { insertAtLineStart("## "); }
+void NotesWidget::insertHeading2() { toggleLinePrefix("## "); }
 
-void NotesWidget::insertHeading3() { insertAtLineStart("### "); }
+void NotesWidget::insertHeading3() { toggleLinePrefix("### "); }
 
 void NotesWidget::insertLink()
 {
@@ -690,11 +1682,8 @@ void NotesWidget::insertLink()
     const QString url = QInputDialog::getText(this, tr("Insert Link"), tr("URL:"), QLineEdit::Normal, "https://", &ok);
 
     if (ok && !url.isEmpty()) {
-        if (selectedText.isEmpty()) {
-            cursor.insertText(QString("[%1](%2)").arg(tr("link text"), url));
-        } else {
-            cursor.insertText(QString("[%1](%2)").arg(selectedText, url));
-        }
+        const QString link = QString("[%1](%2)").arg(selectedText.isEmpty() ? tr("link text") : selectedText, url);
+        m_textEdit->editAsStep(cursor, [&] { cursor.insertText(link); });
         m_textEdit->setTextCursor(cursor);
     }
     m_textEdit->setFocus();
@@ -708,12 +1697,128 @@ void NotesWidget::insertImage()
 
     if (ok && !url.isEmpty()) {
         QTextCursor cursor = m_textEdit->textCursor();
-        cursor.insertText(QString("![%1](%2)").arg(tr("alt text"), url));
+        m_textEdit->editAsStep(cursor, [&] { cursor.insertText(QString("![%1](%2)").arg(tr("alt text"), url)); });
         m_textEdit->setTextCursor(cursor);
     }
     m_textEdit->setFocus();
 }
 
+void NotesWidget::onImagePasted(const QImage& image)
+{
+    insertAttachments(
+        [image](const QString& root) { return QStringList { AttachmentStore::storeImage(root, image) }; },
+        tr("image"));
+}
+
+void NotesWidget::onImageFilesPasted(const QStringList& filePaths)
+{
+    insertAttachments(
+        [filePaths](const QString& root) {
+            QStringList stored;
+            for (const QString& filePath : filePaths) {
+                stored.append(AttachmentStore::storeFile(root, filePath));
+            }
+            return stored;
+        },
+        tr("image"));
+}
+
+void NotesWidget::insertAttachments(
+    const std::function<QStringList(const QString& root)>& store, const QString& altText)
+{
+    if (m_profilePath.isEmpty()) {
+        return;
+    }
+
+    // Remember the insertion point; the cursor follows any typing while the images are stored
+    const int id = m_nextInsertionId++;
+    m_pendingInsertions.insert(id, m_textEdit->textCursor());
+
+    // Encoding, hashing and writing happen off the GUI thread
+    const QString root = AttachmentStore::rootForProfile(m_profilePath);
+    QThreadPool::globalInstance()->start([widget = QPointer<NotesWidget>(this), store, root, altText, id] {
+        const QStringList stored = store(root);
+
+        QMetaObject::invokeMethod(qApp, [widget, stored, altText, id] {
+            if (widget.isNull() || !widget->m_pendingInsertions.contains(id)) {
+                return;
+            }
+            QTextCursor cursor = widget->m_pendingInsertions.take(id);
+
+            QStringList markdown;
+            for (const QString& relativePath : stored) {
+                if (!relativePath.isEmpty()) {
+                    markdown.append(QString("![%1](notes-img://attachments/%2)").arg(altText, relativePath));
+                }
+            }
+            if (markdown.isEmpty()) {
+                qWarning() << "Failed to store pasted image for profile" << widget->m_profilePath;
+                return;
+            }
+            widget->m_textEdit->editAsStep(cursor, [&] { cursor.insertText(markdown.join('\n')); });
+        });
+    });
+}
+
+void NotesWidget::setLoadOrderSource(std::function<LoadOrder::Snapshot()> source)
+{
+    m_loadOrderSource = std::move(source);
+    m_loadOrderAction->setEnabled(m_loadOrderSource != nullptr);
+}
+
+void NotesWidget::insertLoadOrderSnapshot()
+{
+    if (!m_loadOrderSource) {
+        return;
+    }
+    // Reading the lists goes through the organizer on the GUI thread; building the tables does not
+    insertLoadOrderMarkdown([snapshot = m_loadOrderSource()] { return LoadOrder::toMarkdown(snapshot); });
+}
+
+void NotesWidget::compareLoadOrder()
+{
+    if (!m_loadOrderSource) {
+        return;
+    }
+    insertLoadOrderMarkdown([current = m_loadOrderSource(), text = m_textEdit->toPlainText()] {
+        const std::optional<LoadOrder::Snapshot> last = LoadOrder::findLast(text);
+        return last ? LoadOrder::diffToMarkdown(*last, current) : QString();
+    });
+}
+
+void NotesWidget::insertLoadOrderMarkdown(const std::function<QString()>& generate)
+{
+    const int id = m_nextInsertionId++;
+    m_pendingInsertions.insert(id, m_textEdit->textCursor());
+
+    QThreadPool::globalInstance()->start([widget = QPointer<NotesWidget>(this), generate, id] {
+        const QString markdown = generate();
+
+        QMetaObject::invokeMethod(qApp, [widget, markdown, id] {
+            if (widget.isNull() || !widget->m_pendingInsertions.contains(id)) {
+                return;
+            }
+            QTextCursor cursor = widget->m_pendingInsertions.take(id);
+            cursor.clearSelection();
+            if (markdown.isEmpty()) {
+                QMessageBox::information(widget, tr("Load Order"),
+                    tr("There is no load order snapshot in the notes to compare with. Insert one first."));
+                return;
+            }
+
+            // Generated blocks go on lines of their own, and undo as one step
+            widget->m_textEdit->editAsStep(cursor, [&] {
+                if (!cursor.atBlockStart()) {
+                    cursor.movePosition(QTextCursor::EndOfBlock);
+                    cursor.insertText("\n\n");
+                }
+                cursor.insertText(markdown);
+            });
+            widget->m_textEdit->setTextCursor(cursor);
+        });
+    });
+}
+
 void NotesWidget::insertInlineCode() { wrapSelection("`", "`"); }
 
 void NotesWidget::insertCodeBlock()
@@ -721,28 +1826,29 @@ void NotesWidget::insertCodeBlock()
     QTextCursor cursor         = m_textEdit->textCursor();
     const QString selectedText = cursor.selectedText();
 
-    if (selectedText.isEmpty()) {
-        cursor.insertText("```\n" + tr("code") + "\n```");
-    } else {
-        cursor.insertText("```\n" + selectedText + "\n```");
-    }
+    const QString block = "```\n" + (selectedText.isEmpty() ? tr("code") : selectedText) + "\n```";
+    m_textEdit->editAsStep(cursor, [&] { cursor.insertText(block); });
     m_textEdit->setTextCursor(cursor);
     m_textEdit->setFocus();
 }
 
-void NotesWidget::insertBulletList() { insertAtLineStart("- "); }
+void NotesWidget::insertBulletList() { toggleLinePrefix("- "); }
+
+void NotesWidget::insertNumberedList() { toggleLinePrefix("1. "); }
+
+void NotesWidget::insertCheckbox() { toggleLinePrefix("- [ ] "); }
 
-void NotesWidget::insertNumberedList() { insertAtLineStart("1. "); }
+void NotesWidget::insertQuote() { toggleLinePrefix("> "); }
 
-void NotesWidget::insertCheckbox() { insertAtLineStart("- [ ] "); }
+void NotesWidget::indent() { indentLines(false); }
 
-void NotesWidget::insertQuote() { insertAtLineStart("> "); }
+void NotesWidget::outdent() { indentLines(true); }
 
 void NotesWidget::insertHorizontalRule()
 {
     QTextCursor cursor = m_textEdit->textCursor();
     cursor.movePosition(QTextCursor::EndOfLine);
-    cursor.insertText("\n\n---\n");
+    m_textEdit->editAsStep(cursor, [&] { cursor.insertText("\n\n---\n"); });
     m_textEdit->setTextCursor(cursor);
     m_textEdit->setFocus();
 }
@@ -1,37 +1,153 @@
 #pragma once
 
-#include "qmarkdowntextedit.h"
+#include "FindReplaceBar.h"
+#include "ImageSchemeHandler.h"
+#include "LinkCheckBridge.h"
+#include "LogBridge.h"
+#include "NotesTextEdit.h"
+#include "OutlinePanel.h"
+#include "PreviewBridge.h"
+#include "QueryBridge.h"
+#include "core/CompletionIndex.h"
+#include "core/HistoryStore.h"
+#include "core/LoadOrder.h"
+#include "core/ModMentionIndex.h"
+#include "core/OutlineIndex.h"
+#include "core/ReferenceRewrite.h"
+#include "core/SourceMap.h"
+#include "core/TaskIndex.h"
 #include <QFile>
+#include <QHash>
+#include <QMenu>
 #include <QPushButton>
-#include <QStackedWidget>
+#include <QSplitter>
+#include <QTextCursor>
+#include <QThreadPool>
 #include <QToolBar>
 #include <QVBoxLayout>
 #include <QWebEngineView>
 
+#include <functional>
+#include <memory>
+
 class NotesWidget final : public QWidget {
     Q_OBJECT
 
 public:
+    enum class ViewMode {
+        Edit,  // editor only
+        View,  // rendered preview only
+        Split, // editor and preview side by side, scroll-synced
+    };
+
     explicit NotesWidget(QWidget* parent = nullptr);
     ~NotesWidget() override;
 
     static void createDefaultMarkdownStyle(const QString& path);
 
+    // Bundled preview stylesheet, or the profile's notes_style.css override if there is one
+    static QString loadPreviewStyleSheet(const QString& profilePath);
+
     void setProfilePath(const QString& profilePath);
 
     void setDefaultToViewMode(bool viewMode);
 
-    void reloadStyles() const;
+    void reloadStyles();
 
     void saveNotes();
 
+    // Versions older than maxAgeDays are pruned, as are the oldest ones once the history exceeds sizeBudget bytes
+    void setHistoryLimits(int maxAgeDays, qint64 sizeBudget);
+
+    void setUndoMemoryBudget(qsizetype bytes);
+
+    [[nodiscard]] int openTaskCount() const { return m_tasks.openCount(); }
+
+    // Mods whose mentions in the notes are tracked, and which are offered for completion
+    void setModNames(const QStringList& names);
+
+    // Plugins offered for completion, and whose references are tracked for renames
+    void setPluginNames(const QStringList& names);
+
+    // Rewrites references to the old names: in the open notes as one undoable edit, and, if the user agrees, in
+    // the notes of the other profiles on disk. Call before the new names are set.
+    void renameReferences(const QList<ReferenceRewrite::Rename>& mods, const QList<ReferenceRewrite::Rename>& plugins);
+
+    // Whether the notes mention a mod; a hash lookup, cheap enough for painting
+    [[nodiscard]] ModMentionIndex::Presence modPresence(const QString& name) const { return m_mentions.presence(name); }
+
+    [[nodiscard]] int modMentionCount(const QString& name) const { return m_mentions.mentionCount(name); }
+
+    // Unloads the preview page after it has not been shown for this long; 0 keeps it loaded
+    void setPreviewIdleTimeout(int minutes);
+
+    // Reads the current load order for the snapshot commands; called on the GUI thread
+    void setLoadOrderSource(std::function<LoadOrder::Snapshot()> source);
+
+    // Reads the lists ```mo2query blocks are evaluated against; called on the GUI thread when a query needs them
+    void setModQuerySources(
+        std::function<QList<ModQuery::Mod>()> mods, std::function<QList<ModQuery::Plugin>()> plugins);
+
+    // An organizer list changed (ModQuery::Input flags); the query results that read it are evaluated again
+    void invalidateModQueries(int inputs) { m_queryBridge->invalidate(inputs); }
+
+    // Adds a line at the end of the Changelog section, starting the section if there is none, and saves
+    void appendChangelogEntry(const QString& entry);
+
+signals:
+    void openTaskCountChanged(int count);
+
+    // A mod started or stopped being mentioned, or gained or lost a heading
+    void modMentionsChanged();
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
 private slots:
 
     void onTextChanged();
 
     void toggleViewMode();
 
-    void updatePreview() const;
+    void toggleSplitView();
+
+    void updatePreview();
+
+    void syncPreviewToEditor();
+
+    void onPreviewLayoutChanged(const QVariantList& layout);
+
+    void onPreviewScrolled(double offset);
+
+    void onImagePasted(const QImage& image);
+
+    void onImageFilesPasted(const QStringList& filePaths);
+
+    void exportAllProfiles();
+
+    void showHistory();
+
+    void toggleOutline(bool visible);
+
+    void refreshOutline();
+
+    void jumpToHeading(int index);
+
+    void foldSection(int index, bool folded);
+
+    void foldAllSections(bool folded);
+
+    // Folds or unfolds the code block or section around a block
+    void foldAt(int block, bool folded);
+
+    void addFoldActions(QMenu* menu, const QTextCursor& cursor);
+
+    void showTasks();
+
+    void showQuickOpen();
+
+    void suspendPreview();
 
     void setupMarkdownHighlighter() const;
 
@@ -50,28 +166,93 @@ private slots:
     void insertNumberedList();
     void insertCheckbox();
     void insertQuote();
+    void indent();
+    void outdent();
     void insertHorizontalRule();
+    void insertLoadOrderSnapshot();
+    void compareLoadOrder();
 
 private:
-    void initWebView() const;
+    void initWebView();
+    void cachePreviewHtml() const;
+    // While the preview is shown, followed logs are polled and the page is kept; otherwise it counts down to unloading
+    void updatePreviewVisibility(bool widgetVisible);
     void initToolbar();
+    void setViewMode(ViewMode mode);
+    void jumpToLine(int line);
     void applyEditorStyles() const;
     void wrapSelection(const QString& before, const QString& after);
-    void insertAtLineStart(const QString& prefix);
+    // Adds a heading, list or quote marker to the selected lines, or takes it off if they all have it
+    void toggleLinePrefix(const QString& prefix);
+    void indentLines(bool outdent);
+    // Number of the first block and the text of the lines the selection touches
+    [[nodiscard]] std::pair<int, QStringList> selectedLines() const;
+    void replaceSelectedLines(int first, const QStringList& lines);
+    void insertAttachments(const std::function<QStringList(const QString& root)>& store, const QString& altText);
+    void insertLoadOrderMarkdown(const std::function<QString()>& generate);
+    // Asks before patching references to renamed names in the notes of other profiles
+    void rewriteOtherProfiles(
+        const QString& profilesDirectory, QStringList profiles, const QList<ReferenceRewrite::Rename>& renames);
+    [[nodiscard]] QList<NotesTextEdit::Fold> loadFolds() const;
+    void saveFolds();
+    void saveUndoLog();
 
-    QStackedWidget* m_stackedWidget;
-    QMarkdownTextEdit* m_textEdit;
+    QSplitter* m_outlineSplitter;
+    QSplitter* m_splitter;
+    OutlinePanel* m_outlinePanel;
+    NotesTextEdit* m_textEdit;
     QWebEngineView* m_webView;
+    PreviewBridge* m_previewBridge;
+    LogBridge* m_logBridge;
+    QueryBridge* m_queryBridge;
+    LinkCheckBridge* m_linkBridge;
+    ImageSchemeHandler* m_imageHandler;
     QVBoxLayout* m_layout;
     QToolBar* m_toolbar;
+    FindReplaceBar* m_findBar;
     QPushButton* m_toggleButton;
     QAction* m_toggleAction = nullptr;
-    QAction* m_spacerAction = nullptr;
+    QAction* m_splitAction     = nullptr;
+    QAction* m_outlineAction   = nullptr;
+    QAction* m_toolsAction     = nullptr;
+    QMenu* m_toolsMenu         = nullptr;
+    QAction* m_quickOpenAction = nullptr;
+    QAction* m_spacerAction    = nullptr;
+    QAction* m_loadOrderAction = nullptr;
     QString m_profilePath;
+    QString m_lastExportDirectory;
     QTimer* m_saveTimer;
     QTimer* m_previewTimer;
-    bool m_isDirty    = false;
-    bool m_isEditMode = true;
+    QTimer* m_scrollSyncTimer;
+    QTimer* m_outlineTimer;
+    QTimer* m_previewIdleTimer;
+    QTimer* m_undoSaveTimer;
+    SourceMap m_sourceMap;
+    OutlineIndex m_outline;
+    TaskIndex m_tasks;
+    ModMentionIndex m_mentions;
+    ModMentionIndex m_pluginMentions; // only for rewriting references when plugins are renamed
+    QStringList m_pluginNames;        // the names it indexes, sorted
+    CompletionIndex m_completions;
+    ViewMode m_viewMode       = ViewMode::Edit;
+    bool m_isDirty            = false;
+    bool m_syncingFromPreview = false;
+    bool m_foldsDirty         = false; // folds changed since notes_folds.json was written
+    bool m_undoLogDirty       = false; // notes.md was saved since notes.undo was written
+    QString m_previewStyleSheet;
+    bool m_pageLoaded       = false;
+    bool m_previewUpToDate  = false; // the preview shows the current text
+    bool m_previewSuspended = false; // the page was discarded after being idle
+    QString m_suspendedHtml;         // its rendered content, to restore from
+    QString m_suspendedKey;          // PreviewCache key of that content, if it was up to date
+    double m_restoreScroll = -1;
     int m_saveRetryCount = 0;
+    std::shared_ptr<HistoryStore> m_history;
+    QThreadPool m_historyQueue; // single thread, so versions are recorded in order
+    int m_historyMaxAgeDays    = 30;
+    qint64 m_historySizeBudget = 20 * 1024 * 1024;
+    int m_nextInsertionId      = 0;
+    QHash<int, QTextCursor> m_pendingInsertions; // insertion points of text being prepared off the GUI thread
+    std::function<LoadOrder::Snapshot()> m_loadOrderSource;
     static constexpr int MAX_SAVE_RETRIES = 3;
 };
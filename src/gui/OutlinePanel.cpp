@@ -0,0 +1,63 @@
+#include "OutlinePanel.h"
+
+#include <QMenu>
+#include <QVBoxLayout>
+
+namespace {
+constexpr int INDEX_ROLE = Qt::UserRole;
+}
+
+OutlinePanel::OutlinePanel(QWidget* parent)
+    : QWidget(parent)
+    , m_tree(new QTreeWidget(this))
+{
+    m_tree->setHeaderHidden(true);
+    m_tree->setUniformRowHeights(true);
+    m_tree->setContextMenuPolicy(Qt::CustomContextMenu);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_tree);
+
+    connect(m_tree, &QTreeWidget::itemActivated, this,
+        [this](const QTreeWidgetItem* item) { emit headingActivated(item->data(0, INDEX_ROLE).toInt()); });
+    connect(m_tree, &QTreeWidget::itemClicked, this,
+        [this](const QTreeWidgetItem* item) { emit headingActivated(item->data(0, INDEX_ROLE).toInt()); });
+    connect(m_tree, &QTreeWidget::customContextMenuRequested, this, &OutlinePanel::showContextMenu);
+}
+
+void OutlinePanel::setHeadings(const QList<OutlineIndex::Heading>& headings)
+{
+    m_tree->setUpdatesEnabled(false);
+    m_tree->clear();
+
+    // Nest each heading under the closest preceding heading of a lower level
+    QList<std::pair<int, QTreeWidgetItem*>> parents;
+    for (qsizetype i = 0; i < headings.size(); ++i) {
+        while (!parents.isEmpty() && parents.last().first >= headings[i].level) {
+            parents.removeLast();
+        }
+        auto* item = parents.isEmpty() ? new QTreeWidgetItem(m_tree) : new QTreeWidgetItem(parents.last().second);
+        item->setText(0, headings[i].title.isEmpty() ? tr("(untitled)") : headings[i].title);
+        item->setToolTip(0, headings[i].title);
+        item->setData(0, INDEX_ROLE, static_cast<int>(i));
+        parents.append({ headings[i].level, item });
+    }
+
+    m_tree->expandAll();
+    m_tree->setUpdatesEnabled(true);
+}
+
+void OutlinePanel::showContextMenu(const QPoint& position)
+{
+    QMenu menu(this);
+    if (const QTreeWidgetItem* item = m_tree->itemAt(position)) {
+        const int index = item->data(0, INDEX_ROLE).toInt();
+        menu.addAction(tr("Fold Section"), this, [this, index] { emit foldRequested(index, true); });
+        menu.addAction(tr("Unfold Section"), this, [this, index] { emit foldRequested(index, false); });
+        menu.addSeparator();
+    }
+    menu.addAction(tr("Fold All"), this, [this] { emit foldAllRequested(true); });
+    menu.addAction(tr("Unfold All"), this, [this] { emit foldAllRequested(false); });
+    menu.exec(m_tree->viewport()->mapToGlobal(position));
+}
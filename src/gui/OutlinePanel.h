@@ -0,0 +1,27 @@
+#pragma once
+
+#include "core/OutlineIndex.h"
+
+#include <QTreeWidget>
+#include <QWidget>
+
+// Side panel listing the headings of the notes as a tree
+class OutlinePanel final : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit OutlinePanel(QWidget* parent = nullptr);
+
+    void setHeadings(const QList<OutlineIndex::Heading>& headings);
+
+signals:
+    void headingActivated(int index);
+    void foldRequested(int index, bool folded);
+    void foldAllRequested(bool folded);
+
+private slots:
+    void showContextMenu(const QPoint& position);
+
+private:
+    QTreeWidget* m_tree;
+};
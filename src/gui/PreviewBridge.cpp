@@ -0,0 +1,10 @@
+#include "PreviewBridge.h"
+
+PreviewBridge::PreviewBridge(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void PreviewBridge::reportLayout(const QVariantList& layout) { emit layoutChanged(layout); }
+
+void PreviewBridge::reportScroll(const double offset) { emit scrolled(offset); }
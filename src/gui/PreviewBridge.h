@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QObject>
+#include <QVariantList>
+
+// Published to the preview page as "bridge"; the page calls its invokables, the widget listens to the signals
+class PreviewBridge final : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PreviewBridge(QObject* parent = nullptr);
+
+    // Flat [startLine, endLine, top, height, ...] list of the rendered blocks
+    Q_INVOKABLE void reportLayout(const QVariantList& layout);
+
+    // Preview scroll offset in CSS pixels, already throttled to one call per frame
+    Q_INVOKABLE void reportScroll(double offset);
+
+signals:
+    void layoutChanged(const QVariantList& layout);
+    void scrolled(double offset);
+};
@@ -0,0 +1,84 @@
+#include "QueryBridge.h"
+
+#include <utility>
+
+QueryBridge::QueryBridge(QObject* parent)
+    : QObject(parent)
+    , m_settleTimer(new QTimer(this))
+{
+    m_settleTimer->setSingleShot(true);
+    m_settleTimer->setInterval(SETTLE_DELAY);
+    connect(m_settleTimer, &QTimer::timeout, this, [this] { emit invalidated(std::exchange(m_changedInputs, 0)); });
+}
+
+void QueryBridge::setSources(std::function<QList<ModQuery::Mod>()> mods,
+    std::function<QList<ModQuery::Plugin>()> plugins, std::function<bool(const QString& mod)> mentioned)
+{
+    m_modSource    = std::move(mods);
+    m_pluginSource = std::move(plugins);
+    m_mentioned    = std::move(mentioned);
+    invalidate(ModQuery::ModList | ModQuery::PluginList | ModQuery::Notes);
+}
+
+void QueryBridge::invalidate(const int inputs)
+{
+    if (inputs & ModQuery::ModList) {
+        m_mods.reset();
+    }
+    if (inputs & ModQuery::PluginList) {
+        m_plugins.reset();
+    }
+
+    // Nothing shown can be out of date if no result read these inputs
+    const auto removed = m_results.removeIf([inputs](const QHash<QString, QVariantMap>::iterator it) {
+        return (it->value("inputs").toInt() & inputs) != 0;
+    });
+    if (removed > 0) {
+        m_changedInputs |= inputs;
+        m_settleTimer->start();
+    }
+}
+
+QVariantMap QueryBridge::evaluate(const QString& text)
+{
+    const QString key = text.simplified();
+    if (const auto it = m_results.constFind(key); it != m_results.cend()) {
+        return *it;
+    }
+
+    QVariantMap result;
+    QString error;
+    const std::optional<ModQuery::Query> query = ModQuery::parse(key, &error);
+    if (!query) {
+        result.insert("error", error);
+        return result;
+    }
+    if (!m_modSource || !m_pluginSource || !m_mentioned) {
+        result.insert("error", tr("The mod list is not available."));
+        return result;
+    }
+
+    const int inputs = query->inputs();
+    if ((inputs & ModQuery::ModList) && !m_mods) {
+        m_mods = m_modSource();
+    }
+    if ((inputs & ModQuery::PluginList) && !m_plugins) {
+        m_plugins = m_pluginSource();
+    }
+    static const QList<ModQuery::Mod> noMods;
+    static const QList<ModQuery::Plugin> noPlugins;
+    const ModQuery::Table table
+        = ModQuery::evaluate(*query, m_mods ? *m_mods : noMods, m_plugins ? *m_plugins : noPlugins, m_mentioned);
+
+    QVariantList rows;
+    rows.reserve(table.rows.size());
+    for (const QStringList& row : table.rows) {
+        rows.append(QVariant(row));
+    }
+    result.insert("columns", table.columns);
+    result.insert("rows", rows);
+    result.insert("total", table.total);
+    result.insert("inputs", inputs);
+    m_results.insert(key, result);
+    return result;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "core/ModQuery.h"
+
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include <QVariantMap>
+
+#include <functional>
+#include <optional>
+
+// Published to the preview page as "queries"; evaluates the ```mo2query blocks of the notes
+class QueryBridge final : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int SETTLE_DELAY = 500; // ms without changes before the page is told
+
+    explicit QueryBridge(QObject* parent = nullptr);
+
+    // Called on the GUI thread, when a query needs them
+    void setSources(std::function<QList<ModQuery::Mod>()> mods, std::function<QList<ModQuery::Plugin>()> plugins,
+        std::function<bool(const QString& mod)> mentioned);
+
+    // Drops what was read of the inputs (ModQuery::Input flags) and the results that read them
+    void invalidate(int inputs);
+
+    // {"columns": [...], "rows": [[...], ...], "total": rows before the limit, "inputs": ModQuery::Input flags},
+    // or {"error": message}
+    Q_INVOKABLE QVariantMap evaluate(const QString& text);
+
+signals:
+    // Results that read these inputs are out of date
+    void invalidated(int inputs);
+
+private:
+    std::function<QList<ModQuery::Mod>()> m_modSource;
+    std::function<QList<ModQuery::Plugin>()> m_pluginSource;
+    std::function<bool(const QString&)> m_mentioned;
+    std::optional<QList<ModQuery::Mod>> m_mods;       // as last read, until the mod list changes
+    std::optional<QList<ModQuery::Plugin>> m_plugins; // likewise
+    QHash<QString, QVariantMap> m_results;            // by simplified query text
+    QTimer* m_settleTimer;
+    int m_changedInputs = 0; // since the page was last told
+};
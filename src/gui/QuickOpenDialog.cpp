@@ -0,0 +1,235 @@
+#include "QuickOpenDialog.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QDir>
+#include <QFile>
+#include <QKeyEvent>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVBoxLayout>
+
+namespace {
+constexpr int CANDIDATE_ROLE = Qt::UserRole;
+}
+
+QuickOpenDialog::QuickOpenDialog(const QList<OutlineIndex::Heading>& headings, const QList<Command>& commands,
+    const QString& profilesDirectory, const QString& currentProfile, const QString& currentText, QWidget* parent)
+    : QDialog(parent, Qt::Popup)
+    , m_query(new QLineEdit(this))
+    , m_results(new QListWidget(this))
+    , m_status(new QLabel(this))
+    , m_cancel(std::make_shared<std::atomic_bool>(false))
+{
+    resize(600, 400);
+    if (parent != nullptr) {
+        move(parent->mapToGlobal(QPoint((parent->width() - width()) / 2, 0)));
+    }
+
+    m_query->setPlaceholderText(tr("Go to a heading or line, or run a command..."));
+    m_query->installEventFilter(this);
+    m_results->setUniformItemSizes(true);
+    m_results->setFocusPolicy(Qt::NoFocus);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->addWidget(m_query);
+    layout->addWidget(m_results);
+    layout->addWidget(m_status);
+
+    connect(m_query, &QLineEdit::textChanged, this, &QuickOpenDialog::runQuery);
+    connect(m_results, &QListWidget::itemActivated, this, &QuickOpenDialog::activate);
+
+    // Headings and commands can be matched while the notes are read
+    QList<Candidate> candidates;
+    for (const OutlineIndex::Heading& heading : headings) {
+        candidates.append({ Kind::Heading, heading.title, {}, heading.block, {} });
+    }
+    for (const Command& command : commands) {
+        candidates.append({ Kind::Command, command.title, {}, -1, command.action });
+    }
+    QStringList texts;
+    for (const Candidate& candidate : candidates) {
+        texts.append(candidate.text);
+    }
+    setCandidates(std::move(candidates), std::make_shared<const FuzzyMatcher>(texts));
+    for (int i = 0; i < m_candidates.size(); ++i) {
+        m_browseOrder.append(i);
+    }
+    runQuery();
+
+    loadLines(profilesDirectory, currentProfile, currentText);
+}
+
+QuickOpenDialog::~QuickOpenDialog() { m_cancel->store(true); }
+
+void QuickOpenDialog::loadLines(
+    const QString& profilesDirectory, const QString& currentProfile, const QString& currentText)
+{
+    m_status->setText(tr("Reading notes..."));
+
+    QStringList texts;
+    for (const Candidate& candidate : m_candidates) {
+        texts.append(candidate.text);
+    }
+
+    QThreadPool::globalInstance()->start([dialog = QPointer<QuickOpenDialog>(this), texts, profilesDirectory,
+                                             currentProfile, currentText]() mutable {
+        QList<Candidate> lines;
+        for (const QString& profile :
+            QDir(profilesDirectory).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+            QString markdown;
+            if (profile == currentProfile) {
+                markdown = currentText;
+            } else {
+                QFile file(profilesDirectory + "/" + profile + "/notes.md");
+                if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                    continue;
+                }
+                markdown = QTextStream(&file).readAll();
+            }
+
+            int number = 0;
+            for (const QStringView line : QStringView(markdown).split(u'\n')) {
+                if (!line.trimmed().isEmpty()) {
+                    lines.append({ Kind::Line, line.trimmed().toString(),
+                        profile == currentProfile ? QString() : profile, number, {} });
+                    texts.append(line.trimmed().left(MAX_MATCHED_CHARS).toString());
+                }
+                ++number;
+            }
+        }
+        auto matcher = std::make_shared<const FuzzyMatcher>(texts);
+
+        QMetaObject::invokeMethod(qApp, [dialog, lines = std::move(lines), matcher]() mutable {
+            if (!dialog.isNull()) {
+                dialog->m_status->clear();
+                QList<Candidate> candidates = dialog->m_candidates;
+                candidates.append(std::move(lines));
+                dialog->setCandidates(std::move(candidates), matcher);
+                dialog->runQuery();
+            }
+        });
+    });
+}
+
+void QuickOpenDialog::setCandidates(QList<Candidate> candidates, std::shared_ptr<const FuzzyMatcher> matcher)
+{
+    // Results of the old matcher refer to the old candidates
+    m_cancel->store(true);
+    m_candidates = std::move(candidates);
+    m_matcher    = std::move(matcher);
+}
+
+void QuickOpenDialog::runQuery()
+{
+    m_cancel->store(true);
+    m_cancel = std::make_shared<std::atomic_bool>(false);
+
+    const QString query = m_query->text();
+    if (query.trimmed().isEmpty()) {
+        showResults(m_browseOrder.first(std::min<qsizetype>(m_browseOrder.size(), MAX_RESULTS)));
+        return;
+    }
+
+    QThreadPool::globalInstance()->start(
+        [dialog = QPointer<QuickOpenDialog>(this), matcher = m_matcher, cancel = m_cancel, query] {
+            const QList<FuzzyMatcher::Match> matches = matcher->match(query, MAX_RESULTS, cancel.get());
+            if (cancel->load()) {
+                return;
+            }
+            QList<int> candidates;
+            candidates.reserve(matches.size());
+            for (const FuzzyMatcher::Match& match : matches) {
+                candidates.append(match.candidate);
+            }
+
+            QMetaObject::invokeMethod(qApp, [dialog, cancel, candidates] {
+                if (!dialog.isNull() && !cancel->load()) {
+                    dialog->showResults(candidates);
+                }
+            });
+        });
+}
+
+void QuickOpenDialog::showResults(const QList<int>& candidates)
+{
+    m_results->setUpdatesEnabled(false);
+    m_results->clear();
+    for (const int index : candidates) {
+        const Candidate& candidate = m_candidates[index];
+        QString text;
+        switch (candidate.kind) {
+        case Kind::Heading:
+            text = "# " + candidate.text;
+            break;
+        case Kind::Command:
+            text = "> " + candidate.text;
+            break;
+        case Kind::Line:
+            text = tr("%1  —  %2, line %3")
+                       .arg(candidate.text.left(MAX_MATCHED_CHARS),
+                           candidate.profile.isEmpty() ? tr("this profile") : candidate.profile,
+                           QString::number(candidate.line + 1));
+            break;
+        }
+        auto* item = new QListWidgetItem(text, m_results);
+        item->setData(CANDIDATE_ROLE, index);
+        if (candidate.kind == Kind::Line && !candidate.profile.isEmpty()) {
+            item->setToolTip(tr("Enter copies the line"));
+        }
+    }
+    m_results->setCurrentRow(0);
+    m_results->setUpdatesEnabled(true);
+}
+
+void QuickOpenDialog::activate(const QListWidgetItem* item)
+{
+    if (item == nullptr) {
+        return;
+    }
+    const Candidate candidate = m_candidates[item->data(CANDIDATE_ROLE).toInt()];
+    close();
+
+    switch (candidate.kind) {
+    case Kind::Heading:
+        emit lineActivated(candidate.line);
+        break;
+    case Kind::Line:
+        // Lines of other profiles cannot be shown here, but can be brought over
+        if (candidate.profile.isEmpty()) {
+            emit lineActivated(candidate.line);
+        } else {
+            QApplication::clipboard()->setText(candidate.text);
+        }
+        break;
+    case Kind::Command:
+        // Once the palette is gone and the editor has the focus again
+        if (!candidate.action.isNull()) {
+            QTimer::singleShot(0, candidate.action.data(), &QAction::trigger);
+        }
+        break;
+    }
+}
+
+bool QuickOpenDialog::eventFilter(QObject* watched, QEvent* event)
+{
+    // The query keeps the focus; moving through the results is forwarded to the list
+    if (watched == m_query && event->type() == QEvent::KeyPress) {
+        switch (static_cast<QKeyEvent*>(event)->key()) {
+        case Qt::Key_Up:
+        case Qt::Key_Down:
+        case Qt::Key_PageUp:
+        case Qt::Key_PageDown:
+            QApplication::sendEvent(m_results, event);
+            return true;
+        case Qt::Key_Enter:
+        case Qt::Key_Return:
+            activate(m_results->currentItem());
+            return true;
+        default:
+            break;
+        }
+    }
+    return QDialog::eventFilter(watched, event);
+}
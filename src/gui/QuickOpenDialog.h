@@ -0,0 +1,69 @@
+#pragma once
+
+#include "core/FuzzyMatcher.h"
+#include "core/OutlineIndex.h"
+
+#include <QAction>
+#include <QDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QPointer>
+
+#include <atomic>
+#include <memory>
+
+// Palette that fuzzy-matches headings, the lines of every profile's notes and toolbar commands
+class QuickOpenDialog final : public QDialog {
+    Q_OBJECT
+
+public:
+    struct Command {
+        QString title;
+        QPointer<QAction> action;
+    };
+
+    QuickOpenDialog(const QList<OutlineIndex::Heading>& headings, const QList<Command>& commands,
+        const QString& profilesDirectory, const QString& currentProfile, const QString& currentText,
+        QWidget* parent = nullptr);
+    ~QuickOpenDialog() override;
+
+signals:
+    // A heading or line of the current profile was picked
+    void lineActivated(int line);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    enum class Kind {
+        Heading,
+        Line,
+        Command,
+    };
+
+    struct Candidate {
+        Kind kind = Kind::Line;
+        QString text;
+        QString profile; // of a line; empty if it is the current one
+        int line = -1;   // of a heading or line
+        QPointer<QAction> action;
+    };
+
+    static constexpr int MAX_RESULTS       = 200;
+    static constexpr int MAX_MATCHED_CHARS = 200; // of a line; the rest is not matched or shown
+
+    void loadLines(const QString& profilesDirectory, const QString& currentProfile, const QString& currentText);
+    void setCandidates(QList<Candidate> candidates, std::shared_ptr<const FuzzyMatcher> matcher);
+    void runQuery();
+    void showResults(const QList<int>& candidates);
+    void activate(const QListWidgetItem* item);
+
+    QLineEdit* m_query;
+    QListWidget* m_results;
+    QLabel* m_status;
+    QList<Candidate> m_candidates;
+    QList<int> m_browseOrder; // what is listed for an empty query
+    std::shared_ptr<const FuzzyMatcher> m_matcher;
+    std::shared_ptr<std::atomic_bool> m_cancel; // set to drop the query being matched
+};
@@ -0,0 +1,158 @@
+#include "TasksDialog.h"
+
+#include <QApplication>
+#include <QDialogButtonBox>
+#include <QDir>
+#include <QFile>
+#include <QHBoxLayout>
+#include <QPointer>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QVBoxLayout>
+
+#include <algorithm>
+
+namespace {
+constexpr int LINE_ROLE    = Qt::UserRole;
+constexpr int DONE_ROLE    = Qt::UserRole + 1;
+constexpr int CURRENT_ROLE = Qt::UserRole + 2;
+}
+
+TasksDialog::TasksDialog(const QString& profilesDirectory, const QString& currentProfile,
+    const QString& currentText, QWidget* parent)
+    : QDialog(parent)
+    , m_profilesDirectory(profilesDirectory)
+    , m_currentProfile(currentProfile)
+    , m_currentText(currentText)
+    , m_filter(new QLineEdit(this))
+    , m_showDone(new QCheckBox(tr("Show completed"), this))
+    , m_tree(new QTreeWidget(this))
+    , m_summary(new QLabel(this))
+{
+    setWindowTitle(tr("Tasks in All Profiles"));
+    resize(700, 500);
+
+    m_filter->setPlaceholderText(tr("Filter tasks..."));
+    m_filter->setClearButtonEnabled(true);
+    m_tree->setHeaderLabels({ tr("Task"), tr("Line") });
+    m_tree->setUniformRowHeights(true);
+    m_tree->setEnabled(false);
+
+    auto* topRow = new QHBoxLayout();
+    topRow->addWidget(m_filter);
+    topRow->addWidget(m_showDone);
+
+    auto* buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->addLayout(topRow);
+    layout->addWidget(m_tree);
+    layout->addWidget(m_summary);
+    layout->addWidget(buttons);
+
+    connect(m_filter, &QLineEdit::textChanged, this, &TasksDialog::applyFilter);
+    connect(m_showDone, &QCheckBox::toggled, this, &TasksDialog::applyFilter);
+    connect(m_tree, &QTreeWidget::itemActivated, this, [this](const QTreeWidgetItem* item) {
+        if (item->data(0, CURRENT_ROLE).toBool()) {
+            emit taskActivated(item->data(0, LINE_ROLE).toInt());
+        }
+    });
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    loadTasks();
+}
+
+void TasksDialog::loadTasks()
+{
+    m_summary->setText(tr("Loading..."));
+
+    QThreadPool::globalInstance()->start([dialog = QPointer<TasksDialog>(this), directory = m_profilesDirectory,
+                                             currentProfile = m_currentProfile, currentText = m_currentText] {
+        QList<ProfileTasks> profiles;
+        for (const QString& profile : QDir(directory).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+            QString markdown;
+            if (profile == currentProfile) {
+                markdown = currentText;
+            } else {
+                QFile file(directory + "/" + profile + "/notes.md");
+                if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+                    continue;
+                }
+                markdown = QTextStream(&file).readAll();
+            }
+            if (QList<TaskIndex::Task> tasks = TaskIndex::scan(markdown); !tasks.isEmpty()) {
+                profiles.append({ profile, tasks });
+            }
+        }
+
+        QMetaObject::invokeMethod(qApp, [dialog, profiles] {
+            if (!dialog.isNull()) {
+                dialog->showTasks(profiles);
+            }
+        });
+    });
+}
+
+void TasksDialog::showTasks(const QList<ProfileTasks>& profiles)
+{
+    m_tree->setUpdatesEnabled(false);
+    for (const auto& [profile, tasks] : profiles) {
+        const bool current = profile == m_currentProfile;
+        const auto open    = std::count_if(tasks.cbegin(), tasks.cend(), [](const auto& task) { return !task.done; });
+
+        auto* profileItem = new QTreeWidgetItem(m_tree);
+        profileItem->setText(0, tr("%1 (%2 open, %3 total)").arg(profile).arg(open).arg(tasks.size()));
+        profileItem->setFirstColumnSpanned(true);
+        QFont font = profileItem->font(0);
+        font.setBold(current);
+        profileItem->setFont(0, font);
+
+        for (const TaskIndex::Task& task : tasks) {
+            auto* item = new QTreeWidgetItem(profileItem);
+            item->setText(0, task.text);
+            item->setText(1, QString::number(task.line + 1));
+            item->setCheckState(0, task.done ? Qt::Checked : Qt::Unchecked);
+            item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+            item->setData(0, LINE_ROLE, task.line);
+            item->setData(0, DONE_ROLE, task.done);
+            item->setData(0, CURRENT_ROLE, current);
+            if (current) {
+                item->setToolTip(0, tr("Double-click to go to this task"));
+            }
+        }
+    }
+    m_tree->expandAll();
+    m_tree->resizeColumnToContents(1);
+    m_tree->setEnabled(true);
+    m_tree->setUpdatesEnabled(true);
+
+    if (profiles.isEmpty()) {
+        m_summary->setText(tr("No profile has any tasks."));
+    }
+    applyFilter();
+}
+
+void TasksDialog::applyFilter()
+{
+    const QString filter = m_filter->text().trimmed();
+    const bool showDone  = m_showDone->isChecked();
+
+    int shown = 0;
+    for (int i = 0; i < m_tree->topLevelItemCount(); ++i) {
+        QTreeWidgetItem* profileItem = m_tree->topLevelItem(i);
+        int shownInProfile           = 0;
+        for (int j = 0; j < profileItem->childCount(); ++j) {
+            QTreeWidgetItem* item = profileItem->child(j);
+            const bool visible    = (showDone || !item->data(0, DONE_ROLE).toBool())
+                && (filter.isEmpty() || item->text(0).contains(filter, Qt::CaseInsensitive));
+            item->setHidden(!visible);
+            shownInProfile += visible ? 1 : 0;
+        }
+        profileItem->setHidden(shownInProfile == 0);
+        shown += shownInProfile;
+    }
+
+    if (m_tree->topLevelItemCount() > 0) {
+        m_summary->setText(tr("%n task(s) shown", nullptr, shown));
+    }
+}
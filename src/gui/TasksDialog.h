@@ -0,0 +1,42 @@
+#pragma once
+
+#include "core/TaskIndex.h"
+
+#include <QCheckBox>
+#include <QDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QTreeWidget>
+
+// Checkbox tasks of the notes of every profile, filterable by text and state
+class TasksDialog final : public QDialog {
+    Q_OBJECT
+
+public:
+    TasksDialog(const QString& profilesDirectory, const QString& currentProfile, const QString& currentText,
+        QWidget* parent = nullptr);
+
+signals:
+    // A task of the current profile was activated
+    void taskActivated(int line);
+
+private slots:
+    void applyFilter();
+
+private:
+    struct ProfileTasks {
+        QString profile;
+        QList<TaskIndex::Task> tasks;
+    };
+
+    void loadTasks();
+    void showTasks(const QList<ProfileTasks>& profiles);
+
+    QString m_profilesDirectory;
+    QString m_currentProfile;
+    QString m_currentText;
+    QLineEdit* m_filter;
+    QCheckBox* m_showDone;
+    QTreeWidget* m_tree;
+    QLabel* m_summary;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <QIcon>
 #include <QList>
 #include <QString>
 
@@ -28,5 +29,19 @@ public:
     // activate this panel (make it the current tab)
     //
     virtual void activatePanel() = 0;
+
+    // change the text of this panel's tab
+    //
+    virtual void setPanelLabel(const QString& label) = 0;
+
+    // show an icon after mod names in the mod list; icon is called for every visible mod
+    // while painting, so it must be cheap, and a null icon shows nothing
+    //
+    virtual void setModListIndicator(const std::function<QIcon(const QString&)>& icon,
+                                     const std::function<QString(const QString&)>& toolTip) = 0;
+
+    // repaint the mod list indicators after what they show changed
+    //
+    virtual void updateModListIndicators() = 0;
 };
 
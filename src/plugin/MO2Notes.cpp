@@ -1,26 +1,177 @@
 #include "MO2Notes.h"
+#include "gui/ImageSchemeHandler.h"
 #include "gui/NotesWidget.h"
 
+#include <imodinterface.h>
+#include <imodlist.h>
+#include <ipluginlist.h>
+
+#include <QPainter>
 #include <QTimer>
 
+#include <algorithm>
+
 using namespace Qt::Literals::StringLiterals;
 
+namespace {
+// A dot for mods with a section in the notes, a ring for mods that are only mentioned
+QIcon indicatorIcon(const bool filled)
+{
+    QPixmap pixmap(32, 32);
+    pixmap.fill(Qt::transparent);
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    const QColor color(0xd7, 0x99, 0x21); // Gruvbox yellow
+    painter.setPen(QPen(color, 4));
+    painter.setBrush(filled ? QBrush(color) : Qt::NoBrush);
+    painter.drawEllipse(QRectF(6, 6, 20, 20));
+    return QIcon(pixmap);
+}
+}
+
 bool MO2Notes::initPlugin(MOBase::IOrganizer* organizer)
 {
     m_Organizer = organizer;
+
+    // Custom schemes have to be known before WebEngine starts up
+    ImageSchemeHandler::registerScheme();
+
     m_Organizer->onUserInterfaceInitialized([this](QMainWindow*) {
         m_Organizer->onProfileChanged([this](MOBase::IProfile*, const MOBase::IProfile* newProfile) {
             if (m_NotesWidget) {
                 // Save any pending changes to the current profile before switching
+                flushChangelog();
                 m_NotesWidget->saveNotes();
+                // Lists read for the previous profile's queries are not the new profile's
+                m_NotesWidget->invalidateModQueries(ModQuery::ModList | ModQuery::PluginList | ModQuery::Notes);
                 const auto newPath = newProfile->absolutePath();
                 m_NotesWidget->setProfilePath(newPath);
             }
+            // The lists of the new profile are not changes
+            resetChangelog();
+            m_ModAnchors    = modAnchors();
+            m_PluginAnchors = pluginAnchors();
+        });
+
+        // Keep the mod names the notes are indexed for in step with the mod list
+        const auto refreshModNames = [this] {
+            if (m_NotesWidget) {
+                m_NotesWidget->setModNames(modNames());
+            }
+        };
+        // Query blocks in the preview that read a changed list are evaluated again
+        const auto invalidateQueries = [this](const int inputs) {
+            if (m_NotesWidget) {
+                m_NotesWidget->invalidateModQueries(inputs);
+            }
+        };
+        MOBase::IModList* const modList       = m_Organizer->modList();
+        MOBase::IPluginList* const pluginList = m_Organizer->pluginList();
+        modList->onModInstalled([this, refreshModNames, invalidateQueries](MOBase::IModInterface* mod) {
+            refreshModNames();
+            m_ModAnchors = modAnchors();
+            invalidateQueries(ModQuery::ModList);
+            m_Changelog.addInstalled(mod->name());
+            m_ChangelogTimer->start();
+        });
+        modList->onModRemoved([this, refreshModNames, invalidateQueries](const QString& mod) {
+            refreshModNames();
+            m_ModAnchors = modAnchors();
+            invalidateQueries(ModQuery::ModList);
+            m_Changelog.addRemoved(mod);
+            m_ModStates.remove(mod);
+            m_ChangelogTimer->start();
+        });
+
+        // Collect list changes for the changelog until the lists have been left alone for a moment
+        m_ChangelogTimer = new QTimer(this);
+        m_ChangelogTimer->setSingleShot(true);
+        m_ChangelogTimer->setInterval(2000);
+        connect(m_ChangelogTimer, &QTimer::timeout, this, &MO2Notes::flushChangelog);
+        resetChangelog();
+
+        modList->onModStateChanged(
+            [this, invalidateQueries](const std::map<QString, MOBase::IModList::ModStates>& mods) {
+                invalidateQueries(ModQuery::ModList);
+                for (const auto& [mod, state] : mods) {
+                    if (!mod.endsWith(u"_separator"_s)) {
+                        recordState(ChangelogBatch::Kind::Mod, mod, state.testFlag(MOBase::IModList::STATE_ACTIVE));
+                    }
+                }
+            });
+        modList->onModMoved([this, invalidateQueries](const QString& mod, const int from, const int to) {
+            invalidateQueries(ModQuery::ModList);
+            // Anchors hold the priority; a rename after the move would otherwise be taken for another mod
+            m_ModAnchors = modAnchors();
+            if (!mod.endsWith(u"_separator"_s)) {
+                m_Changelog.setPriority(ChangelogBatch::Kind::Mod, mod, from, to);
+                m_ChangelogTimer->start();
+            }
+        });
+        pluginList->onPluginStateChanged(
+            [this, invalidateQueries](const std::map<QString, MOBase::IPluginList::PluginStates>& plugins) {
+                invalidateQueries(ModQuery::PluginList);
+                for (const auto& [plugin, state] : plugins) {
+                    recordState(
+                        ChangelogBatch::Kind::Plugin, plugin, state.testFlag(MOBase::IPluginList::STATE_ACTIVE));
+                }
+            });
+        pluginList->onPluginMoved([this, invalidateQueries](const QString& plugin, const int from, const int to) {
+            invalidateQueries(ModQuery::PluginList);
+            m_Changelog.setPriority(ChangelogBatch::Kind::Plugin, plugin, from, to);
+            m_ChangelogTimer->start();
+        });
+
+        // Plugins come and go with the mods providing them; the list is refreshed after that, and after renames
+        pluginList->onRefreshed([this, invalidateQueries] {
+            rewriteRenamedReferences();
+            if (m_NotesWidget) {
+                m_NotesWidget->setPluginNames(m_Organizer->pluginList()->pluginNames());
+            }
+            invalidateQueries(ModQuery::PluginList);
         });
     });
     return true;
 }
 
+void MO2Notes::resetChangelog()
+{
+    m_ChangelogTimer->stop();
+    m_Changelog.clear();
+
+    // The callbacks only report the new state of an entry, so whether it actually changed is judged from these
+    m_ModStates.clear();
+    m_PluginStates.clear();
+    const MOBase::IModList* mods = m_Organizer->modList();
+    for (const QString& mod : mods->allMods()) {
+        m_ModStates.insert(mod, mods->state(mod).testFlag(MOBase::IModList::STATE_ACTIVE));
+    }
+    const MOBase::IPluginList* plugins = m_Organizer->pluginList();
+    for (const QString& plugin : plugins->pluginNames()) {
+        m_PluginStates.insert(plugin, plugins->state(plugin).testFlag(MOBase::IPluginList::STATE_ACTIVE));
+    }
+}
+
+void MO2Notes::recordState(const ChangelogBatch::Kind kind, const QString& name, const bool enabled)
+{
+    QHash<QString, bool>& states = kind == ChangelogBatch::Kind::Mod ? m_ModStates : m_PluginStates;
+    const auto it                = states.find(name);
+    if (it != states.end() && *it == enabled) {
+        return; // some other flag changed
+    }
+    m_Changelog.setEnabled(kind, name, enabled);
+    states.insert(name, enabled);
+    m_ChangelogTimer->start();
+}
+
+void MO2Notes::flushChangelog()
+{
+    if (m_NotesWidget && !m_Changelog.isEmpty() && m_Organizer->pluginSetting(name(), "auto_changelog").toBool()) {
+        m_NotesWidget->appendChangelogEntry(m_Changelog.entry(QDateTime::currentDateTime()));
+    }
+    m_Changelog.clear();
+}
+
 QString MO2Notes::name() const { return NAME; }
 
 std::vector<std::shared_ptr<const MOBase::IPluginRequirement> > MO2Notes::requirements() const
@@ -44,7 +195,13 @@ QList<MOBase::PluginSetting> MO2Notes::settings() const
 {
     return {
         { "default_to_view_mode", tr("Open in view mode by default"), QVariant(false) },
-        { "open_as_default_tab", tr("Open Notes tab on startup"), QVariant(false) }
+        { "open_as_default_tab", tr("Open Notes tab on startup"), QVariant(false) },
+        { "history_max_age_days", tr("Days to keep old versions of the notes"), QVariant(30) },
+        { "history_max_size_mb", tr("Disk space for old versions of the notes, in MB"), QVariant(20) },
+        { "undo_memory_mb", tr("Memory for the undo history of the notes, in MB"), QVariant(8) },
+        { "preview_idle_minutes", tr("Minutes before a hidden preview is unloaded to save memory (0 = never)"),
+            QVariant(10) },
+        { "auto_changelog", tr("Log mod and plugin list changes to a Changelog section of the notes"), QVariant(false) }
     };
 }
 
@@ -54,11 +211,35 @@ QWidget* MO2Notes::createWidget(IPanelInterface* panelInterface, QWidget* parent
 {
     m_PanelInterface = panelInterface;
     m_NotesWidget = new NotesWidget(parent);
-    m_NotesWidget->setProfilePath(profilePath);
+    m_NotesWidget->setHistoryLimits(m_Organizer->pluginSetting(name(), "history_max_age_days").toInt(),
+        m_Organizer->pluginSetting(name(), "history_max_size_mb").toLongLong() * 1024 * 1024);
+    m_NotesWidget->setPreviewIdleTimeout(m_Organizer->pluginSetting(name(), "preview_idle_minutes").toInt());
+    m_NotesWidget->setUndoMemoryBudget(m_Organizer->pluginSetting(name(), "undo_memory_mb").toLongLong() * 1024 * 1024);
+    connect(m_NotesWidget, &NotesWidget::openTaskCountChanged, this, &MO2Notes::updatePanelLabel);
 
-    // Apply default view mode setting
+    // Apply default view mode setting before loading the profile, so a cached preview can be shown right away
     const bool defaultToViewMode = m_Organizer->pluginSetting(name(), "default_to_view_mode").toBool();
     m_NotesWidget->setDefaultToViewMode(defaultToViewMode);
+    m_NotesWidget->setProfilePath(profilePath);
+
+    // Mark the mods the notes talk about in the mod list
+    m_SectionIcon = indicatorIcon(true);
+    m_MentionIcon = indicatorIcon(false);
+    m_NotesWidget->setModNames(modNames());
+    m_NotesWidget->setPluginNames(m_Organizer->pluginList()->pluginNames());
+    if (m_PanelInterface) {
+        m_PanelInterface->setModListIndicator([this](const QString& mod) { return modIndicator(mod); },
+            [this](const QString& mod) { return modIndicatorToolTip(mod); });
+        connect(m_NotesWidget, &NotesWidget::modMentionsChanged, this,
+            [this] { m_PanelInterface->updateModListIndicators(); });
+    }
+    m_NotesWidget->setLoadOrderSource([this] { return loadOrderSnapshot(); });
+    m_ModAnchors    = modAnchors();
+    m_PluginAnchors = pluginAnchors();
+    m_NotesWidget->setModQuerySources([this] { return queryMods(); }, [this] { return queryPlugins(); });
+
+    // The tab is only created once this returns
+    QTimer::singleShot(0, m_NotesWidget, [this] { updatePanelLabel(m_NotesWidget->openTaskCount()); });
 
     // Activate this tab on startup if setting is enabled
     const bool openAsDefaultTab = m_Organizer->pluginSetting(name(), "open_as_default_tab").toBool();
@@ -74,4 +255,143 @@ QWidget* MO2Notes::createWidget(IPanelInterface* panelInterface, QWidget* parent
 
 QString MO2Notes::label() const { return tr("Notes"); }
 
+void MO2Notes::updatePanelLabel(const int openTasks) const
+{
+    if (m_PanelInterface) {
+        m_PanelInterface->setPanelLabel(openTasks > 0 ? tr("Notes (%1)").arg(openTasks) : label());
+    }
+}
+
+QStringList MO2Notes::modNames() const
+{
+    QStringList names = m_Organizer->modList()->allMods();
+    names.removeIf([](const QString& name) { return name.endsWith(u"_separator"_s); });
+    return names;
+}
+
+LoadOrder::Snapshot MO2Notes::loadOrderSnapshot() const
+{
+    LoadOrder::Snapshot snapshot;
+    snapshot.time = QDateTime::currentDateTime();
+
+    const MOBase::IPluginList* plugins = m_Organizer->pluginList();
+    QList<std::pair<int, QString>> byPriority;
+    for (const QString& plugin : plugins->pluginNames()) {
+        byPriority.append({ plugins->priority(plugin), plugin });
+    }
+    std::ranges::sort(byPriority);
+    snapshot.plugins.reserve(byPriority.size());
+    for (const auto& [priority, plugin] : byPriority) {
+        snapshot.plugins.append({ plugin, plugins->state(plugin).testFlag(MOBase::IPluginList::STATE_ACTIVE) });
+    }
+
+    const MOBase::IModList* mods = m_Organizer->modList();
+    for (const QString& mod : mods->allModsByProfilePriority()) {
+        if (!mod.endsWith(u"_separator"_s)) {
+            snapshot.mods.append({ mod, mods->state(mod).testFlag(MOBase::IModList::STATE_ACTIVE) });
+        }
+    }
+    return snapshot;
+}
+
+QHash<QString, QString> MO2Notes::modAnchors() const
+{
+    const MOBase::IModList* mods = m_Organizer->modList();
+    QHash<QString, QString> anchors;
+    for (const QString& mod : modNames()) {
+        anchors.insert(mod, QString::number(mods->priority(mod)));
+    }
+    return anchors;
+}
+
+QHash<QString, QString> MO2Notes::pluginAnchors() const
+{
+    const MOBase::IPluginList* plugins = m_Organizer->pluginList();
+    QHash<QString, QString> anchors;
+    for (const QString& plugin : plugins->pluginNames()) {
+        anchors.insert(plugin, plugins->origin(plugin));
+    }
+    return anchors;
+}
+
+void MO2Notes::rewriteRenamedReferences()
+{
+    // The organizer has no rename callback; a renamed mod keeps its priority and a renamed plugin its mod
+    const QHash<QString, QString> mods                  = modAnchors();
+    const QHash<QString, QString> plugins               = pluginAnchors();
+    const QList<ReferenceRewrite::Rename> modRenames    = ReferenceRewrite::renamed(m_ModAnchors, mods);
+    const QList<ReferenceRewrite::Rename> pluginRenames = ReferenceRewrite::renamed(m_PluginAnchors, plugins);
+    m_ModAnchors                                        = mods;
+    m_PluginAnchors                                     = plugins;
+    if (!m_NotesWidget || (modRenames.isEmpty() && pluginRenames.isEmpty())) {
+        return;
+    }
+
+    // The indexes still know the old names; the new ones are set once the references have been rewritten
+    m_NotesWidget->renameReferences(modRenames, pluginRenames);
+    if (!modRenames.isEmpty()) {
+        m_NotesWidget->setModNames(modNames());
+    }
+}
+
+QList<ModQuery::Mod> MO2Notes::queryMods() const
+{
+    const MOBase::IModList* mods = m_Organizer->modList();
+    const QStringList names      = mods->allModsByProfilePriority();
+    QList<ModQuery::Mod> result;
+    result.reserve(names.size());
+
+    // Separators sit above the mods they group, at a lower priority
+    QString separator;
+    for (const QString& mod : names) {
+        if (mod.endsWith(u"_separator"_s)) {
+            separator = mod.chopped(u"_separator"_s.size());
+        } else {
+            result.append({ mod, separator, mods->state(mod).testFlag(MOBase::IModList::STATE_ACTIVE) });
+        }
+    }
+    return result;
+}
+
+QList<ModQuery::Plugin> MO2Notes::queryPlugins() const
+{
+    const MOBase::IPluginList* plugins = m_Organizer->pluginList();
+    QList<std::pair<int, QString>> byPriority;
+    for (const QString& plugin : plugins->pluginNames()) {
+        byPriority.append({ plugins->priority(plugin), plugin });
+    }
+    std::ranges::sort(byPriority);
+
+    QList<ModQuery::Plugin> result;
+    result.reserve(byPriority.size());
+    for (const auto& [priority, plugin] : byPriority) {
+        result.append({ plugin, plugins->origin(plugin),
+            plugins->state(plugin).testFlag(MOBase::IPluginList::STATE_ACTIVE) });
+    }
+    return result;
+}
+
+QIcon MO2Notes::modIndicator(const QString& mod) const
+{
+    switch (m_NotesWidget ? m_NotesWidget->modPresence(mod) : ModMentionIndex::Presence::None) {
+    case ModMentionIndex::Presence::Section:
+        return m_SectionIcon;
+    case ModMentionIndex::Presence::Mentioned:
+        return m_MentionIcon;
+    default:
+        return {};
+    }
+}
+
+QString MO2Notes::modIndicatorToolTip(const QString& mod) const
+{
+    if (!m_NotesWidget || m_NotesWidget->modPresence(mod) == ModMentionIndex::Presence::None) {
+        return {};
+    }
+    const int lines = m_NotesWidget->modMentionCount(mod);
+    return m_NotesWidget->modPresence(mod) == ModMentionIndex::Presence::Section
+        ? tr("Has a section in the notes, mentioned on %n line(s)", nullptr, lines)
+        : tr("Mentioned on %n line(s) of the notes", nullptr, lines);
+}
+
 IPluginPanel::Position MO2Notes::position() const { return Position::atEnd(); }
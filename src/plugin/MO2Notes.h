@@ -1,8 +1,13 @@
 #pragma once
 
 #include "IPluginPanel.h"
+#include "core/ChangelogBatch.h"
 #include "gui/NotesWidget.h"
 
+#include <QHash>
+#include <QIcon>
+#include <QTimer>
+
 class MO2Notes final : public IPluginPanel {
     Q_OBJECT
     Q_INTERFACES(MOBase::IPlugin IPluginPanel)
@@ -40,7 +45,44 @@ public:
     [[nodiscard]] Position position() const override;
 
 private:
+    // Shows the number of open tasks in the tab label
+    void updatePanelLabel(int openTasks) const;
+
+    // Installed mods, without separators
+    [[nodiscard]] QStringList modNames() const;
+
+    // Plugins in load order and mods by priority, as the profile has them now
+    [[nodiscard]] LoadOrder::Snapshot loadOrderSnapshot() const;
+
+    // Renames are told apart from removals by what stays put: the priority of a mod, the mod providing a plugin
+    [[nodiscard]] QHash<QString, QString> modAnchors() const;
+    [[nodiscard]] QHash<QString, QString> pluginAnchors() const;
+
+    // Compares the lists with the anchors last seen and rewrites the notes for the names that changed
+    void rewriteRenamedReferences();
+
+    // The lists ```mo2query blocks in the notes are evaluated against
+    [[nodiscard]] QList<ModQuery::Mod> queryMods() const;
+    [[nodiscard]] QList<ModQuery::Plugin> queryPlugins() const;
+
+    // Automatic changelog: list changes are batched until the lists settle, then logged as one entry
+    void resetChangelog();
+    void recordState(ChangelogBatch::Kind kind, const QString& name, bool enabled);
+    void flushChangelog();
+
+    // Mod list indicator for mods with a section in or a mention in the notes
+    [[nodiscard]] QIcon modIndicator(const QString& mod) const;
+    [[nodiscard]] QString modIndicatorToolTip(const QString& mod) const;
+
     MOBase::IOrganizer* m_Organizer{};
     IPanelInterface* m_PanelInterface{};
     NotesWidget* m_NotesWidget{};
+    QIcon m_SectionIcon;
+    QIcon m_MentionIcon;
+    ChangelogBatch m_Changelog;
+    QTimer* m_ChangelogTimer{};
+    QHash<QString, bool> m_ModStates;        // whether each mod is enabled, as last seen
+    QHash<QString, bool> m_PluginStates;     // likewise for plugins
+    QHash<QString, QString> m_ModAnchors;    // mod -> priority, as last seen
+    QHash<QString, QString> m_PluginAnchors; // plugin -> providing mod, as last seen
 };
\ No newline at end of file
@@ -2,12 +2,158 @@
 
 #include <log.h>
 
+#include <QApplication>
+#include <QHelpEvent>
+#include <QPainter>
+#include <QStyle>
+#include <QStyledItemDelegate>
+#include <QToolTip>
+
 #include <algorithm>
 #include <functional>
 #include <iterator>
 
 using namespace Qt::Literals::StringLiterals;
 
+namespace
+{
+
+// draws an icon after the mod name on top of whatever delegate the column already had,
+// forwarding everything else to it
+//
+class ModIndicatorDelegate final : public QStyledItemDelegate
+{
+public:
+  ModIndicatorDelegate(QAbstractItemDelegate* inner,
+                       std::function<QIcon(const QString&)> icon,
+                       std::function<QString(const QString&)> toolTip, QObject* parent)
+      : QStyledItemDelegate(parent), m_Inner{inner}, m_Icon{std::move(icon)},
+        m_ToolTip{std::move(toolTip)}
+  {}
+
+  void paint(QPainter* painter, const QStyleOptionViewItem& option,
+             const QModelIndex& index) const override
+  {
+    const QIcon icon = m_Icon(index.data(Qt::DisplayRole).toString());
+    if (icon.isNull()) {
+      m_Inner->paint(painter, option, index);
+      return;
+    }
+
+    const QStyleOptionViewItem inner = narrowed(option);
+    m_Inner->paint(painter, inner, index);
+
+    // the inner delegate only fills its own rect, so the selection and hover
+    // background of the strip is drawn here before the icon goes on top
+    //
+    QStyleOptionViewItem strip(option);
+    strip.rect.setLeft(inner.rect.right() + 1);
+    const QStyle* style =
+        option.widget ? option.widget->style() : QApplication::style();
+    style->drawPrimitive(QStyle::PE_PanelItemViewItem, &strip, painter,
+                         option.widget);
+    icon.paint(painter, iconRect(option.rect));
+  }
+
+  bool helpEvent(QHelpEvent* event, QAbstractItemView* view,
+                 const QStyleOptionViewItem& option, const QModelIndex& index) override
+  {
+    if (event->type() == QEvent::ToolTip && hasIcon(index) &&
+        iconRect(option.rect).contains(event->pos())) {
+      const QString text = m_ToolTip(index.data(Qt::DisplayRole).toString());
+      if (!text.isEmpty()) {
+        QToolTip::showText(event->globalPos(), text, view);
+        return true;
+      }
+    }
+    return m_Inner->helpEvent(event, view, innerOption(option, index), index);
+  }
+
+  QSize sizeHint(const QStyleOptionViewItem& option,
+                 const QModelIndex& index) const override
+  {
+    QSize size = m_Inner->sizeHint(option, index);
+    if (hasIcon(index)) {
+      size.rwidth() += stripWidth({QPoint(), size});
+    }
+    return size;
+  }
+
+  QWidget* createEditor(QWidget* parent, const QStyleOptionViewItem& option,
+                        const QModelIndex& index) const override
+  {
+    return m_Inner->createEditor(parent, option, index);
+  }
+
+  void setEditorData(QWidget* editor, const QModelIndex& index) const override
+  {
+    m_Inner->setEditorData(editor, index);
+  }
+
+  void setModelData(QWidget* editor, QAbstractItemModel* model,
+                    const QModelIndex& index) const override
+  {
+    m_Inner->setModelData(editor, model, index);
+  }
+
+  void updateEditorGeometry(QWidget* editor, const QStyleOptionViewItem& option,
+                            const QModelIndex& index) const override
+  {
+    m_Inner->updateEditorGeometry(editor, innerOption(option, index), index);
+  }
+
+protected:
+  bool editorEvent(QEvent* event, QAbstractItemModel* model,
+                   const QStyleOptionViewItem& option, const QModelIndex& index) override
+  {
+    return m_Inner->editorEvent(event, model, innerOption(option, index),
+                                index);
+  }
+
+private:
+  static int iconSize(const QRect& cell)
+  {
+    return std::min(cell.height() - 4, 16);
+  }
+
+  // the icon and a 2px margin on each side
+  //
+  static int stripWidth(const QRect& cell) { return iconSize(cell) + 4; }
+
+  static QRect iconRect(const QRect& cell)
+  {
+    const int size = iconSize(cell);
+    return {cell.right() - size - 1, cell.center().y() - size / 2, size, size};
+  }
+
+  bool hasIcon(const QModelIndex& index) const
+  {
+    return !m_Icon(index.data(Qt::DisplayRole).toString()).isNull();
+  }
+
+  // the option with the icon strip taken off the right, so the inner delegate lays
+  // out the name, flags and check state around it
+  //
+  static QStyleOptionViewItem narrowed(const QStyleOptionViewItem& option)
+  {
+    QStyleOptionViewItem inner(option);
+    inner.rect.setRight(option.rect.right() - stripWidth(option.rect));
+    return inner;
+  }
+
+  QStyleOptionViewItem innerOption(const QStyleOptionViewItem& option,
+                                   const QModelIndex& index) const
+  {
+    return hasIcon(index) ? narrowed(option) : option;
+  }
+
+  QAbstractItemDelegate* m_Inner;
+  std::function<QIcon(const QString&)> m_Icon;
+  std::function<QString(const QString&)> m_ToolTip;
+};
+
+}  // namespace
+
 MOPanelInterface::MOPanelInterface(MOBase::IOrganizer* organizer,
                                    QMainWindow* mainWindow)
     : m_ModList{organizer->modList()}, m_PluginList{organizer->pluginList()},
@@ -54,6 +200,40 @@ void MOPanelInterface::activatePanel()
   }
 }
 
+void MOPanelInterface::setPanelLabel(const QString& label)
+{
+  if (m_TabWidget && m_Panel) {
+    const int index = m_TabWidget->indexOf(m_Panel);
+    if (index >= 0) {
+      m_TabWidget->setTabText(index, label);
+    }
+  }
+}
+
+void MOPanelInterface::setModListIndicator(
+    const std::function<QIcon(const QString&)>& icon,
+    const std::function<QString(const QString&)>& toolTip)
+{
+  if (!m_ModListView) {
+    return;
+  }
+
+  // the name column, see onModSelectionChanged()
+  QAbstractItemDelegate* inner = m_ModListView->itemDelegateForColumn(0);
+  if (!inner) {
+    inner = m_ModListView->itemDelegate();
+  }
+  m_ModListView->setItemDelegateForColumn(
+      0, new ModIndicatorDelegate(inner, icon, toolTip, m_ModListView));
+}
+
+void MOPanelInterface::updateModListIndicators()
+{
+  if (m_ModListView) {
+    m_ModListView->viewport()->update();
+  }
+}
+
 void MOPanelInterface::setSelectedFiles(const QList<QString>& selectedFiles)
 {
   if (!m_PluginListView) {
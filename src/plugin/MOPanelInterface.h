@@ -43,6 +43,13 @@ class MOPanelInterface final : public QObject, public IPanelInterface
 
     void activatePanel() override;
 
+    void setPanelLabel(const QString& label) override;
+
+    void setModListIndicator(const std::function<QIcon(const QString&)>& icon,
+                             const std::function<QString(const QString&)>& toolTip) override;
+
+    void updateModListIndicators() override;
+
     private slots:
       void onModSeparatorCollapsed(const QModelIndex& index);
     void onModSeparatorExpanded(const QModelIndex& index);